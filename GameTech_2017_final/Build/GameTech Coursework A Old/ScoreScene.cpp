@@ -56,7 +56,9 @@ void ScoreScene::OnInitializeScene()
 			CommonMeshes::MeshType::TARGET_CUBE);
 
 		targets[i]->SetScore(goodScore);
-		targets[i]->Physics()->SetOnCollisionCallback(
+
+		//Only fired when something starts touching the target, so a projectile left resting against it isn't scored again
+		targets[i]->Physics()->SetOnCollisionEnterCallback(
 			std::bind(&ScoreScene::TargetOnHitCallBack, this,
 				targets[i],
 				std::placeholders::_1,
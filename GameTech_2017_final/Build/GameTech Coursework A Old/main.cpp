@@ -212,6 +212,7 @@ void HandleKeyboardInputs()
 		obj->Physics()->SetElasticity(0.1f);
 		obj->Physics()->SetFriction(0.9f);
 		obj->Physics()->SetLinearVelocity(direction * projectTileSpeed);
+		obj->Physics()->SetBullet(true, 0.5f);
 		SceneManager::Instance()->GetCurrentScene()->AddGameObject(obj);
 	}
 
@@ -239,6 +240,7 @@ void HandleKeyboardInputs()
 		obj->Physics()->SetElasticity(0.2f);
 		obj->Physics()->SetFriction(0.9f);
 		obj->Physics()->SetLinearVelocity(direction * projectTileSpeed);
+		obj->Physics()->SetBullet(true, 0.5f);
 
 		//Initial push??
 		//cube->Physics()->SetLinearVelocity(Quaternion::AxisAngleToQuaterion(Vector3(0.0f, 0.0f, 1.0f), 20.0f).ToMatrix3() * Vector3(-1.f, 0.f, 0.f));
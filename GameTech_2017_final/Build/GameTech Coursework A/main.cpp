@@ -27,6 +27,7 @@ const Vector4 status_color_performance = Vector4(1.0f, 0.6f, 0.6f, 1.0f);
 
 bool draw_debug = false;
 bool show_perf_metrics = false;
+bool toggle_physics_thread = false;	//Applied at the end of the frame, as it can't be done while holding the physics lock
 PerfTimer timer_total, timer_physics, timer_update, timer_render;
 uint shadowCycleKey = 4;
 
@@ -82,6 +83,9 @@ void Initialize()
 
 
 void Quit(bool error, const string &reason) {
+	//Stop the physics thread first, it could still be stepping the nodes the scene is about to delete
+	PhysicsEngine::Instance()->SetThreaded(false);
+
 	//Release Singletons
 	SceneManager::Release();
 	GraphicsPipeline::Release();
@@ -108,6 +112,7 @@ void PrintStatusEntries()
 	//Print Engine Options
 	NCLDebug::AddStatusEntry(status_colour_header, "--- NCLTech Settings ---");
 	NCLDebug::AddStatusEntry(status_colour_header, "     Physics Engine: %s (Press P to toggle)", PhysicsEngine::Instance()->IsPaused() ? "Paused  " : "Enabled ");
+	NCLDebug::AddStatusEntry(status_colour_header, "     Physics Thread: %s (Press N to toggle)", PhysicsEngine::Instance()->IsThreaded() ? "Enabled " : "Disabled");
 	NCLDebug::AddStatusEntry(status_colour_header, "     Monitor V-Sync: %s (Press L to toggle)", GraphicsPipeline::Instance()->GetVsyncEnabled() ? "Enabled " : "Disabled");
 	NCLDebug::AddStatusEntry(status_colour_header, "     Camera Speed: %f [- +]", GraphicsPipeline::Instance()->GetCamera()->GetSpeed());
 
@@ -123,7 +128,8 @@ void PrintStatusEntries()
 		NCLDebug::AddStatusEntry(status_color_debug, " Manifolds         : %s [V]", (drawFlags & DEBUGDRAW_FLAGS_MANIFOLD) ? "Enabled " : "Disabled");
 		NCLDebug::AddStatusEntry(status_color_debug, " Draw Octree       : %s [O]", (drawFlags & DEBUGDRAW_FLAGS_OCTREE) ? "Enabled " : "Disabled");
 		NCLDebug::AddStatusEntry(status_color_debug, " Bounding Radius   : %s [B]", (drawFlags & DEBUGDRAW_FLAGS_BOUNDINGRADIUS) ? "Enabled " : "Disabled");
-		NCLDebug::AddStatusEntry(status_color_debug, " Use Octree        : %s [U]", (PhysicsEngine::Instance()->UsingOctrees()) ? "Enabled " : "Disabled");
+		NCLDebug::AddStatusEntry(status_color_debug, " Broadphase        : %s [U]", PhysicsEngine::Instance()->GetBroadphaseModeName());
+		NCLDebug::AddStatusEntry(status_color_debug, " Narrowphase       : %s [F]", PhysicsEngine::Instance()->GetNarrowphaseModeName());
 		NCLDebug::AddStatusEntry(status_color_debug, " Use SphereSphere  : %s [I]", (PhysicsEngine::Instance()->UsingSphereSphere()) ? "Enabled " : "Disabled");
 		NCLDebug::AddStatusEntry(status_color_debug, "");
 		NCLDebug::AddStatusEntry(status_color_debug, " Sphere Sphere Checks    : %d", PhysicsEngine::Instance()->GetNumSphereSphereChecks());
@@ -157,6 +163,9 @@ void HandleKeyboardInputs()
 	if (Window::GetKeyboard()->KeyTriggered(KEYBOARD_L))
 		GraphicsPipeline::Instance()->SetVsyncEnabled(!GraphicsPipeline::Instance()->GetVsyncEnabled());
 
+	if (Window::GetKeyboard()->KeyTriggered(KEYBOARD_N))
+		toggle_physics_thread = true;
+
 	uint sceneIdx = SceneManager::Instance()->GetCurrentSceneIndex();
 	uint sceneMax = SceneManager::Instance()->SceneCount();
 	if (Window::GetKeyboard()->KeyTriggered(KEYBOARD_Y))
@@ -194,7 +203,16 @@ void HandleKeyboardInputs()
 		drawFlags ^= DEBUGDRAW_FLAGS_BOUNDINGRADIUS;
 
 	if (Window::GetKeyboard()->KeyTriggered(KEYBOARD_U))
-		PhysicsEngine::Instance()->ToggleOctrees();
+	{
+		BroadphaseMode mode = PhysicsEngine::Instance()->GetBroadphaseMode();
+		PhysicsEngine::Instance()->SetBroadphaseMode((BroadphaseMode)((mode + 1) % BROADPHASE_MAX));
+	}
+
+	if (Window::GetKeyboard()->KeyTriggered(KEYBOARD_F))
+	{
+		NarrowphaseMode mode = PhysicsEngine::Instance()->GetNarrowphaseMode();
+		PhysicsEngine::Instance()->SetNarrowphaseMode((NarrowphaseMode)((mode + 1) % NARROWPHASE_MAX));
+	}
 
 	if (Window::GetKeyboard()->KeyTriggered(KEYBOARD_I))
 		PhysicsEngine::Instance()->ToggleSphereSphere();
@@ -223,6 +241,7 @@ void HandleKeyboardInputs()
 		obj->Physics()->SetElasticity(0.1f);
 		obj->Physics()->SetFriction(0.9f);
 		obj->Physics()->SetLinearVelocity(direction * projectTileSpeed);
+		obj->Physics()->SetBullet(true, 0.5f);
 		SceneManager::Instance()->GetCurrentScene()->AddGameObject(obj);
 		SceneManager::Instance()->GetCurrentScene()->AddBallToCPUList(obj);
 	}
@@ -251,6 +270,7 @@ void HandleKeyboardInputs()
 		obj->Physics()->SetElasticity(0.2f);
 		obj->Physics()->SetFriction(0.9f);
 		obj->Physics()->SetLinearVelocity(direction * projectTileSpeed);
+		obj->Physics()->SetBullet(true, 0.5f);
 
 		//Initial push??
 		//cube->Physics()->SetLinearVelocity(Quaternion::AxisAngleToQuaterion(Vector3(0.0f, 0.0f, 1.0f), 20.0f).ToMatrix3() * Vector3(-1.f, 0.f, 0.f));
@@ -280,33 +300,46 @@ int main()
 		timer_update.UpdateRealElapsedTime(dt);
 		timer_render.UpdateRealElapsedTime(dt);
 
-		//Print Status Entries
-		PrintStatusEntries();
+		{
+			//If physics is running on its own thread it has to wait for the game to finish with it
+			// - Only the rendering itself is done without the lock
+			std::unique_lock<std::mutex> physicsLock = PhysicsEngine::Instance()->LockPhysics();
+
+			//Print Status Entries
+			PrintStatusEntries();
 
-		//Handle Keyboard Inputs
-		HandleKeyboardInputs();
+			//Handle Keyboard Inputs
+			HandleKeyboardInputs();
 
-		//Start Timing
-		timer_total.BeginTimingSection();
+			//Start Timing
+			timer_total.BeginTimingSection();
 
-		//Update Scene
-		timer_update.BeginTimingSection();
-		SceneManager::Instance()->GetCurrentScene()->FireOnSceneUpdate(dt);
-		timer_update.EndTimingSection();
+			//Update Scene
+			timer_update.BeginTimingSection();
+			SceneManager::Instance()->GetCurrentScene()->FireOnSceneUpdate(dt);
+			timer_update.EndTimingSection();
 
-		//Update Physics
-		timer_physics.BeginTimingSection();
-		PhysicsEngine::Instance()->Update(dt);
-		timer_physics.EndTimingSection();
-		PhysicsEngine::Instance()->DebugRender();
+			//Update Physics
+			timer_physics.BeginTimingSection();
+			PhysicsEngine::Instance()->Update(dt);
+			timer_physics.EndTimingSection();
+			PhysicsEngine::Instance()->DebugRender();
+
+			timer_render.BeginTimingSection();
+			GraphicsPipeline::Instance()->UpdateScene(dt);
+		}
 
 		//Render Scene
-		timer_render.BeginTimingSection();
-		GraphicsPipeline::Instance()->UpdateScene(dt);
 		GraphicsPipeline::Instance()->RenderScene();
 		timer_render.EndTimingSection();
 
 		timer_total.EndTimingSection();
+
+		if (toggle_physics_thread)
+		{
+			PhysicsEngine::Instance()->SetThreaded(!PhysicsEngine::Instance()->IsThreaded());
+			toggle_physics_thread = false;
+		}
 	}
 
 	//Cleanup
@@ -0,0 +1,24 @@
+/******************************************************************************
+Class: ChildMeshInterface (headless)
+Description:
+
+	Stand-in for nclgl/ChildMeshInterface.h used by the Linux build of the
+	PhysicsBenchmark (see Mesh.h).
+
+*//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "Mesh.h"
+#include <vector>
+
+class ChildMeshInterface
+{
+public:
+	virtual ~ChildMeshInterface() {}
+
+	void AddChild(Mesh* m) { children.push_back(m); }
+	const std::vector<Mesh*>& GetChildren() const { return children; }
+
+protected:
+	std::vector<Mesh*> children;
+};
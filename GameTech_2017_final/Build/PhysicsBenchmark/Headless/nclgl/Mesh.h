@@ -0,0 +1,25 @@
+/******************************************************************************
+Class: Mesh (headless)
+Description:
+
+	Stand-in for nclgl/Mesh.h used by the Linux build of the PhysicsBenchmark (see
+	NCLDebug.h). Only holds the vertex positions ConvexHullCollisionShape can be built
+	from, there is nothing to upload them to or draw them with.
+
+*//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <nclgl/Vector3.h>
+#include <cstddef>
+
+typedef unsigned int GLuint;
+
+class Mesh
+{
+public:
+	Mesh() : numVertices(0), vertices(NULL) {}
+	virtual ~Mesh() { delete[] vertices; }
+
+	GLuint		numVertices;
+	Vector3*	vertices;
+};
@@ -0,0 +1,104 @@
+/******************************************************************************
+Class: NCLDebug (headless)
+Author:
+	Pieran Marris <p.marris@newcastle.ac.uk> and YOU!
+Description:
+
+	Stand-in for nclgl/NCLDebug.h used by the Linux build of the PhysicsBenchmark, which
+	has no window or GL context to draw with. It comes before the real nclgl in the include
+	path (see CMakeLists.txt), so anything including <nclgl/NCLDebug.h> gets this instead.
+
+	Every draw call does nothing, while log entries and errors are printed to the console
+	the same as the real NCLDebug does before the renderer has started.
+
+*//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <nclgl/Matrix4.h>
+#include <nclgl/Matrix3.h>
+#include <nclgl/Vector4.h>
+#include <nclgl/Vector3.h>
+#include <cstdio>
+#include <cstdarg>
+#include <string>
+
+enum TextAlignment
+{
+	TEXTALIGN_LEFT,
+	TEXTALIGN_RIGHT,
+	TEXTALIGN_CENTRE
+};
+
+#define NCLERROR(str, ...) {NCLDebug::LogE(__FILE__, __LINE__, str, ##__VA_ARGS__);}
+#define NCLLOG(str, ...) NCLDebug::Log(str, ##__VA_ARGS__)
+
+class NCLDebug
+{
+public:
+	static void DrawPoint(const Vector3& pos, float point_radius, const Vector3& color) {}
+	static void DrawPoint(const Vector3& pos, float point_radius, const Vector4& color = Vector4(1.0f, 1.0f, 1.0f, 1.0f)) {}
+	static void DrawPointNDT(const Vector3& pos, float point_radius, const Vector3& color) {}
+	static void DrawPointNDT(const Vector3& pos, float point_radius, const Vector4& color = Vector4(1.0f, 1.0f, 1.0f, 1.0f)) {}
+
+	static void DrawThickLine(const Vector3& start, const Vector3& end, float line_width, const Vector3& color) {}
+	static void DrawThickLine(const Vector3& start, const Vector3& end, float line_width, const Vector4& color = Vector4(1.0f, 1.0f, 1.0f, 1.0f)) {}
+	static void DrawThickLineNDT(const Vector3& start, const Vector3& end, float line_width, const Vector3& color) {}
+	static void DrawThickLineNDT(const Vector3& start, const Vector3& end, float line_width, const Vector4& color = Vector4(1.0f, 1.0f, 1.0f, 1.0f)) {}
+
+	static void DrawHairLine(const Vector3& start, const Vector3& end, const Vector3& color) {}
+	static void DrawHairLine(const Vector3& start, const Vector3& end, const Vector4& color = Vector4(1.0f, 1.0f, 1.0f, 1.0f)) {}
+	static void DrawHairLineNDT(const Vector3& start, const Vector3& end, const Vector3& color) {}
+	static void DrawHairLineNDT(const Vector3& start, const Vector3& end, const Vector4& color = Vector4(1.0f, 1.0f, 1.0f, 1.0f)) {}
+
+	static void DrawMatrix(const Matrix4& transform_mtx) {}
+	static void DrawMatrix(const Matrix3& rotation_mtx, const Vector3& position) {}
+	static void DrawMatrixNDT(const Matrix4& transform_mtx) {}
+	static void DrawMatrixNDT(const Matrix3& rotation_mtx, const Vector3& position) {}
+
+	static void DrawTriangle(const Vector3& v0, const Vector3& v1, const Vector3& v2, const Vector4& color = Vector4(1.0f, 1.0f, 1.0f, 1.0f)) {}
+	static void DrawTriangleNDT(const Vector3& v0, const Vector3& v1, const Vector3& v2, const Vector4& color = Vector4(1.0f, 1.0f, 1.0f, 1.0f)) {}
+
+	static void DrawPolygon(int n_verts, const Vector3* verts, const Vector4& color = Vector4(1.0f, 1.0f, 1.0f, 1.0f)) {}
+	static void DrawPolygonNDT(int n_verts, const Vector3* verts, const Vector4& color = Vector4(1.0f, 1.0f, 1.0f, 1.0f)) {}
+
+	static void DrawTextWs(const Vector3& pos, const float font_size, const TextAlignment alignment, const Vector4 color, const char* text, ...) {}
+	static void DrawTextWsNDT(const Vector3& pos, const float font_size, const TextAlignment alignment, const Vector4 color, const char* text, ...) {}
+	static void DrawTextCs(const Vector4& pos, const float font_size, const std::string& text, const TextAlignment alignment = TEXTALIGN_LEFT, const Vector4 color = Vector4(1.0f, 1.0f, 1.0f, 1.0f)) {}
+
+	//There is no status display, these are only ever meant to be seen on screen
+	static void AddStatusEntry(const Vector4& color, const char* text, ...) {}
+
+	static void Log(const Vector3& color, const char* text, ...)
+	{
+		va_list args;
+		va_start(args, text);
+		PrintLine("", text, args);
+		va_end(args);
+	}
+
+	static void Log(const char* text, ...)
+	{
+		va_list args;
+		va_start(args, text);
+		PrintLine("", text, args);
+		va_end(args);
+	}
+
+	static void LogE(const char* filename, int linenumber, const char* text, ...)
+	{
+		printf("[ERROR] %s:%d\n", filename, linenumber);
+
+		va_list args;
+		va_start(args, text);
+		PrintLine("\t", text, args);
+		va_end(args);
+	}
+
+protected:
+	static void PrintLine(const char* prefix, const char* text, va_list args)
+	{
+		printf("%s", prefix);
+		vprintf(text, args);
+		printf("\n");
+	}
+};
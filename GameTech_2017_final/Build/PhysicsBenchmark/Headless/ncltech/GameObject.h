@@ -0,0 +1,24 @@
+/******************************************************************************
+Class: GameObject (headless)
+Description:
+
+	Stand-in for ncltech/GameObject.h used by the Linux build of the
+	PhysicsBenchmark. The real one drags in the graphics pipeline; the physics
+	engine only needs to be able to detach a deleted PhysicsNode from it.
+
+*//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <ncltech/PhysicsNode.h>
+
+class GameObject
+{
+public:
+	virtual ~GameObject() {}
+
+	inline void SetPhysics(PhysicsNode* node) { physicsNode = node; }
+	inline PhysicsNode* Physics() { return physicsNode; }
+
+protected:
+	PhysicsNode* physicsNode = NULL;
+};
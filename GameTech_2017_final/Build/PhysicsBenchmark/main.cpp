@@ -0,0 +1,332 @@
+#include <ncltech/PhysicsEngine.h>
+#include <ncltech/SphereCollisionShape.h>
+#include <ncltech/CuboidCollisionShape.h>
+#include <ncltech/ConvexHullCollisionShape.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+//Headless physics benchmark
+//
+//Builds each test scene directly from PhysicsNodes (no GameObjects, RenderNodes, Window or GL context) and runs it
+//for a fixed number of steps under every broadphase and narrowphase mode, with and without the sphere-sphere culling pass.
+//The time spent in each stage of the engine along with the average number of pairs and manifolds per step are
+//written out as one CSV row per run, so results can be compared between builds to catch performance regressions.
+//
+//Usage: PhysicsBenchmark [output.csv] [steps] [object count]
+
+#define DEFAULT_STEPS 300
+#define DEFAULT_NUM_OBJECTS 200
+#define BENCHMARK_SEED 8503
+#define HULL_NUM_POINTS 60			//Points each random hull is built around, most end up as hull vertices
+
+#define RAND() ((rand() % 101) / 100.0f)
+
+enum BenchmarkScene
+{
+	SCENE_SPHERES = 0,
+	SCENE_CUBOIDS,
+	SCENE_PYRAMID,
+	SCENE_BALLPOOL,
+	SCENE_HULLS,
+	SCENE_MAX
+};
+
+const char* GetSceneName(BenchmarkScene scene)
+{
+	switch (scene)
+	{
+	case SCENE_SPHERES:		return "Spheres";
+	case SCENE_CUBOIDS:		return "Cuboids";
+	case SCENE_PYRAMID:		return "Pyramid";
+	case SCENE_HULLS:		return "Hulls";
+	default:				return "Ball Pool";
+	}
+}
+
+PhysicsNode* AddSphere(const Vector3& pos, float radius, float inverse_mass)
+{
+	PhysicsNode* pnode = new PhysicsNode();
+	pnode->SetPosition(pos);
+	pnode->SetInverseMass(inverse_mass);
+	pnode->SetBoundingRadius(radius);
+
+	CollisionShape* pColshape = new SphereCollisionShape(radius);
+	pnode->SetCollisionShape(pColshape);
+	pnode->SetInverseInertia(pColshape->BuildInverseInertia(inverse_mass));
+
+	PhysicsEngine::Instance()->AddPhysicsObject(pnode);
+	return pnode;
+}
+
+PhysicsNode* AddCuboid(const Vector3& pos, const Vector3& halfdims, float inverse_mass)
+{
+	PhysicsNode* pnode = new PhysicsNode();
+	pnode->SetPosition(pos);
+	pnode->SetInverseMass(inverse_mass);
+	pnode->SetBoundingRadius(halfdims.Length());
+
+	CollisionShape* pColshape = new CuboidCollisionShape(halfdims);
+	pnode->SetCollisionShape(pColshape);
+	pnode->SetInverseInertia(pColshape->BuildInverseInertia(inverse_mass));
+
+	PhysicsEngine::Instance()->AddPhysicsObject(pnode);
+	return pnode;
+}
+
+//Random rock shaped hull, built from points that aren't centred on the origin so the hull has to be moved
+// onto its centre of mass
+PhysicsNode* AddHull(const Vector3& pos, float radius, float inverse_mass)
+{
+	Vector3 points[HULL_NUM_POINTS];
+	for (int i = 0; i < HULL_NUM_POINTS; ++i)
+	{
+		Vector3 dir = Vector3(RAND() - 0.5f, RAND() - 0.5f, RAND() - 0.5f);
+		if (Vector3::Dot(dir, dir) < 1e-4f)
+		{
+			dir = Vector3(0.0f, 1.0f, 0.0f);
+		}
+		dir.Normalise();
+
+		points[i] = dir * radius * (0.7f + 0.3f * RAND()) + Vector3(radius * 0.5f, 0.0f, 0.0f);
+	}
+
+	ConvexHullCollisionShape* pColshape = new ConvexHullCollisionShape(points, HULL_NUM_POINTS);
+
+	PhysicsNode* pnode = new PhysicsNode();
+	pnode->SetPosition(pos);
+	pnode->SetInverseMass(inverse_mass);
+	pnode->SetBoundingRadius(pColshape->GetBoundingRadius());
+	pnode->SetCollisionShape(pColshape);
+	pnode->SetInverseInertia(pColshape->BuildInverseInertia(inverse_mass));
+
+	PhysicsEngine::Instance()->AddPhysicsObject(pnode);
+	return pnode;
+}
+
+//Number of objects along each side of a square grid holding at least the given number of objects
+int GridSide(int numObjects)
+{
+	int side = 1;
+	while (side * side < numObjects)
+	{
+		++side;
+	}
+	return side;
+}
+
+//Build the scene with (roughly) the given number of dynamic objects
+void BuildScene(BenchmarkScene scene, int numObjects)
+{
+	switch (scene)
+	{
+	case SCENE_SPHERES:
+	case SCENE_CUBOIDS:
+	case SCENE_HULLS:
+	{
+		//Objects dropped in layers onto a floor big enough to hold them all
+		const int side = GridSide(numObjects);
+		const float spacing = 1.5f;
+		const float halfSize = side * spacing * 0.5f + 1.0f;
+		AddCuboid(Vector3(0.0f, -1.0f, 0.0f), Vector3(halfSize, 1.0f, halfSize), 0.0f);
+
+		for (int i = 0; i < numObjects; ++i)
+		{
+			const int x = i % side;
+			const int z = (i / side) % side;
+			Vector3 pos = Vector3(
+				(x - side * 0.5f) * spacing + RAND() * 0.2f,
+				1.0f + RAND() * 5.0f,
+				(z - side * 0.5f) * spacing + RAND() * 0.2f);
+
+			PhysicsNode* pnode;
+			if (scene == SCENE_SPHERES)
+			{
+				pnode = AddSphere(pos, 0.5f, 1.0f);
+			}
+			else if (scene == SCENE_CUBOIDS)
+			{
+				pnode = AddCuboid(pos, Vector3(0.5f, 0.5f, 0.5f), 1.0f);
+			}
+			else
+			{
+				//Hulls always go through GJK, whichever narrowphase mode is set
+				pnode = AddHull(pos, 0.6f, 1.0f);
+			}
+
+			pnode->SetOrientation(Quaternion::AxisAngleToQuaterion(Vector3(RAND(), RAND(), RAND() + 0.1f).Normalise(), RAND() * 360.0f));
+			pnode->SetElasticity(0.2f);
+		}
+		break;
+	}
+
+	case SCENE_PYRAMID:
+	{
+		//Same layout as PyramidScene, with the stack height picked to give about the requested number of cubes
+		int stackHeight = 1;
+		while ((stackHeight + 1) * (stackHeight + 2) / 2 <= numObjects)
+		{
+			++stackHeight;
+		}
+
+		AddCuboid(Vector3(0.0f, -1.0f, 0.0f), Vector3(20.0f, 1.0f, 20.0f), 0.0f);
+
+		for (int y = 0; y < stackHeight; ++y)
+		{
+			for (int x = 0; x <= y; ++x)
+			{
+				PhysicsNode* cube = AddCuboid(
+					Vector3(x * 1.1f - y * 0.5f, 0.5f + float(stackHeight - 1) - y, -0.5f),
+					Vector3(0.5f, 0.5f, 0.5f),
+					1.0f);
+				cube->SetElasticity(0.0f);
+				cube->SetFriction(1.0f);
+			}
+		}
+		break;
+	}
+
+	default:
+	{
+		//Same layout as BallPoolScene
+		const float poolX = 15.0f, poolY = 5.0f, poolZ = 15.0f;
+		AddCuboid(Vector3(0.0f, -1.0f, 0.0f), Vector3(poolX, 1.0f, poolZ), 0.0f);
+		AddCuboid(Vector3(poolX + 1.0f, 3.0f, 0.0f), Vector3(1.0f, poolY, poolZ), 0.0f);
+		AddCuboid(Vector3(-poolX - 1.0f, 3.0f, 0.0f), Vector3(1.0f, poolY, poolZ), 0.0f);
+		AddCuboid(Vector3(0.0f, 3.0f, poolZ + 1.0f), Vector3(poolX, poolY, 1.0f), 0.0f);
+		AddCuboid(Vector3(0.0f, 3.0f, -poolZ - 1.0f), Vector3(poolX, poolY, 1.0f), 0.0f);
+
+		for (int i = 0; i < numObjects; ++i)
+		{
+			Vector3 pos = Vector3(-poolX + 1.0f + RAND() * (poolX - 1.0f) * 2.0f,
+				poolY + RAND() * poolY + 1.0f * 2.0f,
+				-poolZ + 1.0f + RAND() * (poolZ - 1.0f) * 2.0f);
+
+			PhysicsNode* ball = AddSphere(pos, 0.5f, 1.0f / 10.0f);
+			ball->SetElasticity(0.2f);
+			ball->SetFriction(0.9f);
+		}
+		break;
+	}
+	}
+}
+
+//Run a single scene/broadphase/narrowphase/culling combination and write its results to the csv
+void RunBenchmark(FILE* csv, BenchmarkScene scene, BroadphaseMode mode, NarrowphaseMode narrowphase, bool sphereSphere, int numSteps, int numObjects)
+{
+	PhysicsEngine* engine = PhysicsEngine::Instance();
+
+	//Every run starts from the same random state so each mode simulates exactly the same scene
+	engine->RemoveAllPhysicsObjects();
+	engine->SetDefaults();
+	engine->SetBroadphaseMode(mode);
+	engine->SetNarrowphaseMode(narrowphase);
+	engine->SetSphereSphere(sphereSphere);
+	srand(BENCHMARK_SEED);
+	BuildScene(scene, numObjects);
+
+	engine->GetIntegrationTimer().ResetTotal();
+	engine->GetBroadphaseTimer().ResetTotal();
+	engine->GetNarrowphaseTimer().ResetTotal();
+	engine->GetSolverTimer().ResetTotal();
+
+	size_t totalSphereChecks = 0, totalPairs = 0, totalManifolds = 0, totalSleeping = 0, totalSolverIterations = 0;
+	size_t totalArenaAllocations = 0, totalArenaBytes = 0;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < numSteps; ++i)
+	{
+		//Passing exactly one timestep runs exactly one physics update
+		engine->Update(engine->GetUpdateTimestep());
+
+		totalSphereChecks += engine->GetNumSphereSphereChecks();
+		totalPairs += engine->GetNumBroadphasePairs();
+		totalManifolds += engine->GetNumManifolds();
+		totalSleeping += engine->GetNumSleepingObjects();
+		totalSolverIterations += engine->GetNumSolverIterations();
+		totalArenaAllocations += engine->GetNumStepAllocations();
+		totalArenaBytes += engine->GetStepAllocatedBytes();
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	const float totalMs = std::chrono::duration<float, std::milli>(end - start).count();
+	const float steps = (float)numSteps;
+
+	fprintf(csv, "%s,%d,%s,%s,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.1f,%.1f,%.1f,%.1f,%.2f,%.1f,%.2f\n",
+		GetSceneName(scene),
+		(int)engine->GetNumPhysicsObjects(),
+		engine->GetBroadphaseModeName(),
+		engine->GetNarrowphaseModeName(),
+		sphereSphere ? 1 : 0,
+		numSteps,
+		totalMs,
+		engine->GetIntegrationTimer().GetTotal(),
+		engine->GetBroadphaseTimer().GetTotal(),
+		engine->GetNarrowphaseTimer().GetTotal(),
+		engine->GetSolverTimer().GetTotal(),
+		totalSphereChecks / steps,
+		totalPairs / steps,
+		totalManifolds / steps,
+		totalSleeping / steps,
+		totalSolverIterations / steps,
+		totalArenaAllocations / steps,
+		totalArenaBytes / steps / 1024.0f);
+	fflush(csv);
+
+	printf("%-10s %-15s %-8s sphere-sphere %-3s %10.1fms (broadphase %8.1fms, narrowphase %8.1fms, solver %8.1fms) %8.1f pairs/step %5.1f solver its/step\n",
+		GetSceneName(scene),
+		engine->GetBroadphaseModeName(),
+		engine->GetNarrowphaseModeName(),
+		sphereSphere ? "on" : "off",
+		totalMs,
+		engine->GetBroadphaseTimer().GetTotal(),
+		engine->GetNarrowphaseTimer().GetTotal(),
+		engine->GetSolverTimer().GetTotal(),
+		totalPairs / steps,
+		totalSolverIterations / steps);
+}
+
+int main(int argc, char** argv)
+{
+	const char* csvPath = argc > 1 ? argv[1] : "physics_benchmark.csv";
+	const int numSteps = argc > 2 ? atoi(argv[2]) : DEFAULT_STEPS;
+	const int numObjects = argc > 3 ? atoi(argv[3]) : DEFAULT_NUM_OBJECTS;
+
+	if (numSteps <= 0 || numObjects <= 0)
+	{
+		printf("Usage: %s [output.csv] [steps] [object count]\n", argv[0]);
+		return 1;
+	}
+
+	FILE* csv = fopen(csvPath, "w");
+	if (!csv)
+	{
+		printf("Unable to open %s for writing\n", csvPath);
+		return 1;
+	}
+
+	fprintf(csv, "scene,objects,broadphase,narrowphase,sphere_sphere,steps,total_ms,integration_ms,broadphase_ms,narrowphase_ms,solver_ms,"
+		"sphere_checks_per_step,pairs_per_step,manifolds_per_step,sleeping_per_step,solver_iterations_per_step,"
+		"arena_allocations_per_step,arena_kb_per_step\n");
+
+	for (int scene = 0; scene < SCENE_MAX; ++scene)
+	{
+		for (int mode = 0; mode < BROADPHASE_MAX; ++mode)
+		{
+			for (int narrowphase = 0; narrowphase < NARROWPHASE_MAX; ++narrowphase)
+			{
+				RunBenchmark(csv, (BenchmarkScene)scene, (BroadphaseMode)mode, (NarrowphaseMode)narrowphase, true, numSteps, numObjects);
+				RunBenchmark(csv, (BenchmarkScene)scene, (BroadphaseMode)mode, (NarrowphaseMode)narrowphase, false, numSteps, numObjects);
+			}
+		}
+	}
+
+	fclose(csv);
+	PhysicsEngine::Instance()->RemoveAllPhysicsObjects();
+	PhysicsEngine::Release();
+
+	printf("Results written to %s\n", csvPath);
+	return 0;
+}
@@ -73,7 +73,10 @@ public:
 		city1->SetPhysics(new PhysicsNode());
 		city1->Physics()->SetPosition(Vector3(-5.0f, col_size1.y, -5.0f));
 		city1->Physics()->SetCollisionShape(new CuboidCollisionShape(col_size1));
-		city1->Physics()->SetOnCollisionCallback(&Phy4_AiCallbacks::ExampleCallbackFunction1);
+		city1->Physics()->SetOnCollisionEnterCallback(&Phy4_AiCallbacks::ExampleCallbackFunction1);
+		city1->Physics()->SetOnCollisionExitCallback([](PhysicsNode* self, PhysicsNode* collidingObject) {
+			NCLDebug::Log(Vector3(0.3f, 1.0f, 0.3f), "Player has left the Yellow City! - Inline exit callback");
+		});
 
 		this->AddGameObject(city1);
 
@@ -122,9 +125,10 @@ public:
 	//Example of static callback (cannot use 'this' parameter)
 	static bool ExampleCallbackFunction1(PhysicsNode* self, PhysicsNode* collidingObject)
 	{
-		NCLDebug::Log(Vector3(0.3f, 1.0f, 0.3f), "Player is inside the Yellow City! - Static callback");
+		NCLDebug::Log(Vector3(0.3f, 1.0f, 0.3f), "Player has entered the Yellow City! - Static callback");
 
 		//Return true to enable collision resolution, for AI test's just return false so we can drop the collision pair from the system
+		// - As this is the enter callback, the pair stays dropped until the player leaves the city
 		return false; 
 	}
 
@@ -31,6 +31,10 @@ public:
 		children.push_back(m);
 	}
 
+	const std::vector<Mesh*>& GetChildren() const	{
+		return children;
+	}
+
 	virtual ~ChildMeshInterface() {
 		for(unsigned int i = 0; i < children.size(); ++i) {
 			delete children.at(i);
@@ -1,8 +1,12 @@
 #include "GameTimer.h"
 
 GameTimer::GameTimer(void)	{
+#ifdef _WIN32
 	QueryPerformanceFrequency((LARGE_INTEGER *)&frequency);
 	QueryPerformanceCounter((LARGE_INTEGER *)&start);
+#else
+	start = std::chrono::steady_clock::now();
+#endif
 
 	lastTime = GetMS();
 }
@@ -11,9 +15,13 @@ GameTimer::GameTimer(void)	{
 Returns the Milliseconds since timer was started
 */
 float GameTimer::GetMS() {
+#ifdef _WIN32
 	LARGE_INTEGER t;	
 	QueryPerformanceCounter(&t);
 	return (float)((t.QuadPart  - start.QuadPart) * 1000.0 / frequency.QuadPart);
+#else
+	return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+#endif
 }
 
 float	 GameTimer::GetTimedMS() {
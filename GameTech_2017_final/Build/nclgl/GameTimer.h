@@ -1,7 +1,7 @@
 /******************************************************************************
 Class:GameTimer
 Author:Rich Davison
-Description:Wraps Windows PerformanceCounter. GameTimers keep track of how much
+Description:Wraps Windows PerformanceCounter (std::chrono elsewhere). GameTimers keep track of how much
 time has passed since they were last polled - so you could use multiple
 GameTimers to trigger events at different time periods. 
 
@@ -14,7 +14,11 @@ _-_-_-_-_-_-_-""  ""
 
 #pragma once
 
+#ifdef _WIN32
 #include "Windows.h"
+#else
+#include <chrono>
+#endif
 
 class GameTimer	{
 public:
@@ -28,8 +32,12 @@ public:
 	float	GetTimedMS();
 
 protected:
+#ifdef _WIN32
 	LARGE_INTEGER	start;			//Start of timer
 	LARGE_INTEGER	frequency;		//Ticks Per Second
+#else
+	std::chrono::steady_clock::time_point start;	//Start of timer
+#endif
 
 	float lastTime;					//Last time GetTimedMS was called
 };
@@ -16,6 +16,7 @@ _-_-_-_-_-_-_-""  ""
 #pragma once
 
 #include <iostream>
+#include <cstring>
 #include "common.h"
 #include "Vector3.h"
 #include "Vector4.h"
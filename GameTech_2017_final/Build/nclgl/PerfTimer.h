@@ -19,7 +19,8 @@ time of the various components of the game engine.
 
 #pragma once
 #include "GameTimer.h"
-#include "NCLDebug.h"
+#include <cstring>
+#include <nclgl/NCLDebug.h>		//Not "NCLDebug.h", so headless builds can put their own NCLDebug first in the include path
 
 class PerfTimer
 {
@@ -27,6 +28,7 @@ public:
 	PerfTimer()
 		: m_UpdateInterval(1.0f)
 		, m_RealTimeElapsed(0.0f)
+		, m_TotalTime(0.0f)
 	{
 		m_Timer.GetTimedMS();
 		memset(&m_CurrentData, 0, sizeof(PerfTimer_Data));
@@ -45,6 +47,11 @@ public:
 	//Returns the average execution time
 	inline float GetAvg() const { return m_PreviousData._sum / float(m_PreviousData._num); }
 
+	//Returns the total execution time recorded since the last call to ResetTotal
+	// - Unlike the values above this is never reset automatically, so it can be used to time long runs
+	inline float GetTotal() const { return m_TotalTime; }
+	inline void ResetTotal() { m_TotalTime = 0.0f; }
+
 	//Changes the rate at which the results are updated/replaced
 	void SetUpdateInterval(float seconds) { m_UpdateInterval = seconds; }
 
@@ -76,6 +83,7 @@ public:
 		//Accumulate data required for calculating average execution time
 		m_CurrentData._num++;
 		m_CurrentData._sum += elapsed;
+		m_TotalTime += elapsed;
 	}
 
 
@@ -104,6 +112,7 @@ public:
 protected:
 	float m_UpdateInterval;
 	float m_RealTimeElapsed;
+	float m_TotalTime;
 
 	GameTimer m_Timer;
 
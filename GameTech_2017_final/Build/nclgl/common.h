@@ -12,6 +12,8 @@ _-_-_-_-_-_-_-""  ""
 
 #pragma once
 
+#include <cfloat>
+
 #define WEEK_2_CODE
 #define USE_MD5MESH
 #define WEEK_3_CODE
@@ -35,6 +37,16 @@ static inline double DegToRad(const double rad)	{
 typedef unsigned int uint;
 
 //I blame Microsoft...
+// - MSVC's standard headers cope with these macros, but libstdc++ uses min/max as names, so outside MSVC
+//   the headers that do have to be included before the macros are defined
+#ifndef _MSC_VER
+#include <algorithm>
+#include <limits>
+#include <chrono>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+#endif
 #define max(a,b)    (((a) > (b)) ? (a) : (b))
 #define min(a,b)    (((a) < (b)) ? (a) : (b))
 
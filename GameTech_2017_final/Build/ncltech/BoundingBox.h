@@ -14,9 +14,9 @@ with graphics frustum culling by using both AABB and bounding sphere's inside Sc
 *//////////////////////////////////////////////////////////////////////////////
 
 #pragma once
-#include <nclgl\Matrix4.h>
-#include <nclgl\Vector3.h>
-#include <nclgl\common.h>
+#include <nclgl/Matrix4.h>
+#include <nclgl/Vector3.h>
+#include <nclgl/common.h>
 
 struct BoundingBox
 {
@@ -47,6 +47,36 @@ struct BoundingBox
 		_max.z = max(_max.z, point.z);
 	}
 
+	//Expand the boundingbox to fit another boundingbox
+	void ExpandToFit(const BoundingBox& box)
+	{
+		ExpandToFit(box._min);
+		ExpandToFit(box._max);
+	}
+
+	//Surface area of the box, used as the cost of a node in bounding volume hierarchies
+	float SurfaceArea() const
+	{
+		Vector3 d = _max - _min;
+		return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+	}
+
+	//Returns true if the given AABB is entirely inside this one
+	bool Contains(const BoundingBox& other) const
+	{
+		return other._min.x >= _min.x && other._max.x <= _max.x
+			&& other._min.y >= _min.y && other._max.y <= _max.y
+			&& other._min.z >= _min.z && other._max.z <= _max.z;
+	}
+
+	//Returns true if the given AABB overlaps this one
+	bool Intersects(const BoundingBox& other) const
+	{
+		return other._max.x > _min.x && other._min.x < _max.x
+			&& other._max.y > _min.y && other._min.y < _max.y
+			&& other._max.z > _min.z && other._min.z < _max.z;
+	}
+
 	//Transform the given AABB (Axis Aligned Bounding Box) and returns a new AABB that encapsulates the new rotated bounding box.
 	BoundingBox Transform(const Matrix4& mtx)
 	{
@@ -0,0 +1,353 @@
+#include "Cloth.h"
+#include "SphereCollisionShape.h"
+#include "CuboidCollisionShape.h"
+#include <nclgl/NCLDebug.h>
+
+//Finds how far a particle of the given radius is inside a rigid body
+// - Returns false if the particle isn't touching the body, otherwise the normal points out of the body
+//   towards the particle and the depth is the distance the particle has to move to be just touching it
+static bool ParticleInsideNode(const PhysicsNode* pnode, const Vector3& point, float radius, Vector3& out_normal, float& out_depth)
+{
+	const CollisionShape* shape = pnode->GetCollisionShape();
+
+	if (shape->GetType() == COLLISION_SHAPE_CUBOID)
+	{
+		const Vector3& halfDims = static_cast<const CuboidCollisionShape*>(shape)->GetHalfDims();
+
+		//The columns of the cuboid's world transform are its local axes
+		const Matrix4& transform = pnode->GetWorldSpaceTransform();
+		const Vector3 axisX = Vector3(transform[0], transform[1], transform[2]);
+		const Vector3 axisY = Vector3(transform[4], transform[5], transform[6]);
+		const Vector3 axisZ = Vector3(transform[8], transform[9], transform[10]);
+
+		const Vector3 rel = point - pnode->GetPosition();
+		const Vector3 local = Vector3(Vector3::Dot(rel, axisX), Vector3::Dot(rel, axisY), Vector3::Dot(rel, axisZ));
+
+		const Vector3 closest = Vector3(
+			min(max(local.x, -halfDims.x), halfDims.x),
+			min(max(local.y, -halfDims.y), halfDims.y),
+			min(max(local.z, -halfDims.z), halfDims.z));
+
+		Vector3 localNormal;
+		const Vector3 diff = local - closest;
+		const float distSq = Vector3::Dot(diff, diff);
+		if (distSq > 0.0f)
+		{
+			if (distSq >= radius * radius)
+			{
+				return false;
+			}
+
+			const float dist = sqrtf(distSq);
+			localNormal = diff / dist;
+			out_depth = radius - dist;
+		}
+		else
+		{
+			//Particle centre is inside the cuboid, push it out through the nearest face
+			const Vector3 faceDist = halfDims - Vector3(fabs(local.x), fabs(local.y), fabs(local.z));
+			if (faceDist.x <= faceDist.y && faceDist.x <= faceDist.z)
+			{
+				localNormal = Vector3(local.x < 0.0f ? -1.0f : 1.0f, 0.0f, 0.0f);
+				out_depth = faceDist.x + radius;
+			}
+			else if (faceDist.y <= faceDist.z)
+			{
+				localNormal = Vector3(0.0f, local.y < 0.0f ? -1.0f : 1.0f, 0.0f);
+				out_depth = faceDist.y + radius;
+			}
+			else
+			{
+				localNormal = Vector3(0.0f, 0.0f, local.z < 0.0f ? -1.0f : 1.0f);
+				out_depth = faceDist.z + radius;
+			}
+		}
+
+		out_normal = axisX * localNormal.x + axisY * localNormal.y + axisZ * localNormal.z;
+		return true;
+	}
+
+	//Spheres, and any other shape is approximated by its bounding sphere
+	const float nodeRadius = (shape->GetType() == COLLISION_SHAPE_SPHERE)
+		? static_cast<const SphereCollisionShape*>(shape)->GetRadius()
+		: pnode->GetBoundingRadius();
+	const float radiusSum = nodeRadius + radius;
+
+	const Vector3 ab = point - pnode->GetPosition();
+	const float distSq = Vector3::Dot(ab, ab);
+	if (distSq >= radiusSum * radiusSum)
+	{
+		return false;
+	}
+
+	const float dist = sqrtf(distSq);
+	out_normal = (dist > 1e-6f) ? ab / dist : Vector3(0.0f, 1.0f, 0.0f);
+	out_depth = radiusSum - dist;
+	return true;
+}
+
+Cloth::Cloth(float particleRadius)
+	: particleRadius(particleRadius)
+	, coloursDirty(false)
+	, numSubsteps(CLOTH_DEFAULT_SUBSTEPS)
+	, collidable(true)
+	, parallel(true)
+	, friction(0.5f)
+{
+	colourStart.push_back(0);
+}
+
+Cloth::~Cloth()
+{
+}
+
+unsigned int Cloth::AddParticle(const Vector3& position, float invMass)
+{
+	positions.push_back(position);
+	prevPositions.push_back(position);
+	velocities.push_back(Vector3(0.0f, 0.0f, 0.0f));
+	invMasses.push_back(invMass);
+
+	worldAABB.ExpandToFit(position);
+	return (unsigned int)positions.size() - 1;
+}
+
+void Cloth::AddDistanceConstraint(unsigned int a, unsigned int b, float compliance)
+{
+	ClothConstraint c;
+	c.a = a;
+	c.b = b;
+	c.restLength = (positions[b] - positions[a]).Length();
+	c.compliance = compliance;
+
+	constraints.push_back(c);
+	coloursDirty = true;
+}
+
+void Cloth::ColourConstraints()
+{
+	//Greedy colouring, each constraint takes the lowest colour not already used by either of its particles
+	std::vector<uint64_t> particleColours(positions.size(), 0);
+	std::vector<unsigned int> constraintColours(constraints.size());
+	unsigned int numColours = 0;
+
+	for (size_t i = 0; i < constraints.size(); ++i)
+	{
+		const ClothConstraint& c = constraints[i];
+		const uint64_t used = particleColours[c.a] | particleColours[c.b];
+
+		unsigned int colour = 0;
+		while (colour < CLOTH_MAX_COLOURS && (used & (1ULL << colour)))
+		{
+			++colour;
+		}
+
+		if (colour < CLOTH_MAX_COLOURS)
+		{
+			particleColours[c.a] |= (1ULL << colour);
+			particleColours[c.b] |= (1ULL << colour);
+			numColours = max(numColours, colour + 1);
+		}
+		constraintColours[i] = colour;
+	}
+
+	//Counting sort by colour, anything that couldn't be coloured goes at the end
+	std::vector<unsigned int> counts(CLOTH_MAX_COLOURS + 1, 0);
+	for (unsigned int colour : constraintColours)
+	{
+		counts[colour]++;
+	}
+
+	colourStart.assign(numColours + 1, 0);
+	std::vector<unsigned int> offsets(CLOTH_MAX_COLOURS + 1, 0);
+	unsigned int total = 0;
+	for (unsigned int colour = 0; colour <= CLOTH_MAX_COLOURS; ++colour)
+	{
+		if (colour <= numColours) colourStart[colour] = total;
+		offsets[colour] = total;
+		total += counts[colour];
+	}
+
+	std::vector<ClothConstraint> sorted(constraints.size());
+	for (size_t i = 0; i < constraints.size(); ++i)
+	{
+		sorted[offsets[constraintColours[i]]++] = constraints[i];
+	}
+	constraints.swap(sorted);
+
+	coloursDirty = false;
+}
+
+void Cloth::Update(float dt, const Vector3& gravity, float damping, const std::vector<PhysicsNode*>& rigidNodes)
+{
+	if (positions.empty())
+	{
+		return;
+	}
+
+	if (coloursDirty)
+	{
+		ColourConstraints();
+	}
+
+	const unsigned int numParticles = (unsigned int)positions.size();
+	const float h = dt / numSubsteps;
+	const float invH2 = 1.0f / (h * h);
+
+	//Damping is applied once per physics update, the same as the rigid bodies
+	float maxSpeedSq = 0.0f;
+	for (unsigned int i = 0; i < numParticles; ++i)
+	{
+		velocities[i] = velocities[i] * damping;
+		maxSpeedSq = max(maxSpeedSq, Vector3::Dot(velocities[i], velocities[i]));
+	}
+
+	//Only rigid bodies near the cloth are collided against, the AABB is grown by how far any particle could move
+	colliders.clear();
+	if (collidable)
+	{
+		UpdateAABB();
+		const float margin = particleRadius + (sqrtf(maxSpeedSq) + gravity.Length() * dt) * dt;
+		const BoundingBox bounds = BoundingBox(
+			worldAABB._min - Vector3(margin, margin, margin),
+			worldAABB._max + Vector3(margin, margin, margin));
+
+		for (PhysicsNode* pnode : rigidNodes)
+		{
+			if (pnode->GetCollisionShape() && bounds.Intersects(pnode->GetWorldSpaceAABB()))
+			{
+				colliders.push_back(pnode);
+			}
+		}
+	}
+
+	for (unsigned int step = 0; step < numSubsteps; ++step)
+	{
+		//Predict the new positions
+		for (unsigned int i = 0; i < numParticles; ++i)
+		{
+			prevPositions[i] = positions[i];
+			if (invMasses[i] > 0.0f)
+			{
+				velocities[i] += gravity * h;
+				positions[i] += velocities[i] * h;
+			}
+		}
+
+		//Project the constraints one colour at a time
+		for (unsigned int colour = 0; colour < GetNumColours(); ++colour)
+		{
+			const int first = (int)colourStart[colour];
+			const int last = (int)colourStart[colour + 1];
+
+#pragma omp parallel for schedule(static) if (parallel && last - first >= CLOTH_PARALLEL_MIN_CONSTRAINTS)
+			for (int i = first; i < last; ++i)
+			{
+				SolveDistanceConstraint(i, constraints[i].compliance * invH2);
+			}
+		}
+
+		for (unsigned int i = colourStart.back(); i < constraints.size(); ++i)
+		{
+			SolveDistanceConstraint(i, constraints[i].compliance * invH2);
+		}
+
+		if (!colliders.empty())
+		{
+			SolveCollisions();
+		}
+
+		//The velocity is whatever took the particle from its old position to its new one
+		for (unsigned int i = 0; i < numParticles; ++i)
+		{
+			velocities[i] = (positions[i] - prevPositions[i]) / h;
+		}
+	}
+
+	UpdateAABB();
+}
+
+void Cloth::SolveDistanceConstraint(unsigned int i, float alphaTilde)
+{
+	const ClothConstraint& c = constraints[i];
+	const float wA = invMasses[c.a];
+	const float wB = invMasses[c.b];
+	const float w = wA + wB;
+	if (w <= 0.0f)
+	{
+		return;
+	}
+
+	const Vector3 ab = positions[c.a] - positions[c.b];
+	const float length = ab.Length();
+	if (length < 1e-6f)
+	{
+		return;
+	}
+
+	//The lagrange multiplier starts at zero every substep, as each substep only does a single iteration
+	const float error = length - c.restLength;
+	const float deltaLambda = -error / (w + alphaTilde);
+
+	const Vector3 n = ab / length;
+	positions[c.a] += n * (deltaLambda * wA);
+	positions[c.b] -= n * (deltaLambda * wB);
+}
+
+void Cloth::SolveCollisions()
+{
+	Vector3 normal;
+	float depth;
+
+	for (size_t i = 0; i < positions.size(); ++i)
+	{
+		if (invMasses[i] <= 0.0f)
+		{
+			continue;
+		}
+
+		for (PhysicsNode* pnode : colliders)
+		{
+			const BoundingBox& aabb = pnode->GetWorldSpaceAABB();
+			const Vector3& p = positions[i];
+			if (p.x + particleRadius < aabb._min.x || p.x - particleRadius > aabb._max.x
+				|| p.y + particleRadius < aabb._min.y || p.y - particleRadius > aabb._max.y
+				|| p.z + particleRadius < aabb._min.z || p.z - particleRadius > aabb._max.z)
+			{
+				continue;
+			}
+
+			if (!ParticleInsideNode(pnode, p, particleRadius, normal, depth))
+			{
+				continue;
+			}
+
+			positions[i] += normal * depth;
+
+			//Friction removes some of the particle's sliding motion this substep
+			const Vector3 moved = positions[i] - prevPositions[i];
+			const Vector3 tangent = moved - normal * Vector3::Dot(moved, normal);
+			positions[i] -= tangent * min(friction * pnode->GetFriction(), 1.0f);
+		}
+	}
+}
+
+void Cloth::UpdateAABB()
+{
+	worldAABB = BoundingBox();
+	for (const Vector3& p : positions)
+	{
+		worldAABB.ExpandToFit(p);
+	}
+
+	worldAABB._min = worldAABB._min - Vector3(particleRadius, particleRadius, particleRadius);
+	worldAABB._max = worldAABB._max + Vector3(particleRadius, particleRadius, particleRadius);
+}
+
+void Cloth::DebugDraw() const
+{
+	for (const ClothConstraint& c : constraints)
+	{
+		NCLDebug::DrawThickLine(positions[c.a], positions[c.b], 0.02f, Vector4(0.0f, 0.0f, 1.0f, 1.0f));
+	}
+}
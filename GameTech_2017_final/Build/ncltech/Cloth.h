@@ -0,0 +1,122 @@
+#pragma once
+
+#include "PhysicsNode.h"
+#include "BoundingBox.h"
+#include <nclgl/Vector3.h>
+#include <vector>
+#include <functional>
+
+//Position based cloth simulation (XPBD)
+//
+//Cloth is simulated separately from the rigid bodies, as a set of particles held in flat arrays and joined by
+//distance constraints. Each physics update the cloth is split into a number of substeps, each of which:
+//		1: Predicts the new particle positions from their velocities and gravity
+//		2: Projects every distance constraint once, moving the particles directly (XPBD)
+//		3: Pushes any particles inside a rigid body back out to its surface
+//		4: Derives the new velocities from how far the particles moved
+//
+//XPBD (extended position based dynamics) gives each constraint a compliance (inverse stiffness) in m/N, so the
+//stiffness doesn't depend on the number of substeps. A compliance of zero is a rigid link.
+//
+//The constraints are coloured when the cloth is built so that no two constraints in a colour share a particle.
+//Each colour can then be projected in parallel with OpenMP.
+//
+//Collisions with rigid bodies are one way, the particles are pushed out of the rigid bodies but the rigid bodies
+//are never moved by the cloth. This keeps the cloth from feeding large position corrections back into the rigid
+//body solver, and means a cloth resting on a sleeping rigid body doesn't keep it awake.
+
+#define CLOTH_DEFAULT_SUBSTEPS 8
+#define CLOTH_MAX_COLOURS 64					//Colours are tracked as bitmasks, anything that doesn't fit is projected on one thread
+#define CLOTH_PARALLEL_MIN_CONSTRAINTS 256		//Smaller colours aren't worth the threading overhead
+
+//Called by the physics engine after every update of the cloth, so meshes etc. can be updated from the new particle
+// positions. With threaded physics this is called from the game thread once per frame instead.
+typedef std::function<void()> ClothUpdateCallback;
+
+class Cloth
+{
+public:
+	Cloth(float particleRadius);
+	~Cloth();
+
+	//Adds a particle and returns its index
+	unsigned int AddParticle(const Vector3& position, float invMass);
+
+	//Joins two particles at their current distance apart
+	void AddDistanceConstraint(unsigned int a, unsigned int b, float compliance = 0.0f);
+
+	//Runs the cloth forward by one physics timestep
+	// - The rigid bodies are only collided against, anything else about them is left to the physics engine
+	void Update(float dt, const Vector3& gravity, float damping, const std::vector<PhysicsNode*>& rigidNodes);
+
+	void DebugDraw() const;
+
+	//<--------- GETTERS ------------->
+	inline size_t				GetNumParticles()				const { return positions.size(); }
+	inline size_t				GetNumConstraints()				const { return constraints.size(); }
+	inline unsigned int			GetNumColours()					const { return (unsigned int)colourStart.size() - 1; }
+	inline const Vector3&		GetPosition(unsigned int i)		const { return positions[i]; }
+	inline const Vector3&		GetVelocity(unsigned int i)		const { return velocities[i]; }
+	inline float				GetInverseMass(unsigned int i)	const { return invMasses[i]; }
+	inline const BoundingBox&	GetWorldSpaceAABB()				const { return worldAABB; }
+	inline unsigned int			GetSubsteps()					const { return numSubsteps; }
+	inline bool					GetCollidable()					const { return collidable; }
+	inline bool					GetParallel()					const { return parallel; }
+	inline float				GetFriction()					const { return friction; }
+
+	//<--------- SETTERS ------------->
+	//Moving a particle also moves its previous position, so it doesn't pick up a velocity from the jump
+	inline void SetPosition(unsigned int i, const Vector3& pos)		{ positions[i] = pos; prevPositions[i] = pos; }
+	inline void SetVelocity(unsigned int i, const Vector3& vel)		{ velocities[i] = vel; }
+	inline void SetInverseMass(unsigned int i, float invMass)		{ invMasses[i] = invMass; }
+	inline void SetSubsteps(unsigned int substeps)					{ numSubsteps = max(substeps, 1u); }
+	inline void SetCollidable(bool c)								{ collidable = c; }
+	inline void SetParallel(bool p)									{ parallel = p; }
+	inline void SetFriction(float f)								{ friction = f; }
+
+	inline void SetOnUpdateCallback(ClothUpdateCallback callback)	{ onUpdateCallback = callback; }
+	inline void FireOnUpdateCallback()								{ if (onUpdateCallback) onUpdateCallback(); }
+
+protected:
+	//Sorts the constraints into colours that don't share any particles
+	void ColourConstraints();
+
+	//Projects a single distance constraint, alphaTilde is the compliance divided by the substep squared
+	void SolveDistanceConstraint(unsigned int i, float alphaTilde);
+
+	//Pushes the particles out of any rigid bodies they have moved into
+	void SolveCollisions();
+
+	void UpdateAABB();
+
+	struct ClothConstraint
+	{
+		unsigned int	a;
+		unsigned int	b;
+		float			restLength;
+		float			compliance;
+	};
+
+	//Particles
+	float					particleRadius;
+	std::vector<Vector3>	positions;
+	std::vector<Vector3>	prevPositions;		//Positions at the start of the current substep
+	std::vector<Vector3>	velocities;
+	std::vector<float>		invMasses;
+
+	//Constraints, sorted by colour
+	std::vector<ClothConstraint>	constraints;
+	std::vector<unsigned int>		colourStart;		//Index of the first constraint in each colour, plus the total at the end
+	bool							coloursDirty;
+
+	//Rigid bodies overlapping the cloth this update
+	std::vector<PhysicsNode*>		colliders;
+
+	BoundingBox				worldAABB;
+	unsigned int			numSubsteps;
+	bool					collidable;
+	bool					parallel;
+	float					friction;			//Fraction of a particle's sliding motion removed on contact with a rigid body
+
+	ClothUpdateCallback		onUpdateCallback;
+};
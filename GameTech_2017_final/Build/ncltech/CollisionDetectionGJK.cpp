@@ -0,0 +1,445 @@
+#include "CollisionDetectionGJK.h"
+#include "CollisionDispatch.h"
+
+CollisionDetectionGJK::CollisionDetectionGJK(FrameArena* arena)
+	: arena(arena)
+	, simplexSize(0)
+	, numEpaVertices(0)
+	, numEpaFaces(0)
+	, numEpaEdges(0)
+	, hasCachedAxis(false)
+{
+}
+
+void CollisionDetectionGJK::BeginNewPair(
+	PhysicsNode* obj1,
+	PhysicsNode* obj2,
+	CollisionShape* shape1,
+	CollisionShape* shape2,
+	const Vector3* cached)
+{
+	simplexSize = 0;
+
+	hasCachedAxis = (cached != NULL);
+	if (cached)
+	{
+		cachedAxis = *cached;
+	}
+
+	pnodeA = obj1;
+	pnodeB = obj2;
+	cshapeA = obj1->GetCollisionShape();
+	cshapeB = obj2->GetCollisionShape();
+
+	areColliding = false;
+}
+
+CollisionDetectionGJK::SupportPoint CollisionDetectionGJK::Support(const Vector3& dir) const
+{
+	SupportPoint s;
+	s.a = cshapeA->GetSupportPoint(dir);
+	s.b = cshapeB->GetSupportPoint(-dir);
+	s.p = s.a - s.b;
+	return s;
+}
+
+
+
+bool CollisionDetectionGJK::AreColliding(CollisionData* out_coldata)
+{
+	if (!cshapeA || !cshapeB)
+	{
+		return false;
+	}
+
+	areColliding = false;
+
+	//Start searching along the axis that separated the pair last step, or otherwise from A towards B. Either way the
+	//direction is faced from A to B, as a separating direction found by GJK always points that way.
+	const Vector3 ab = pnodeB->GetPosition() - pnodeA->GetPosition();
+	Vector3 dir = hasCachedAxis ? cachedAxis : ab;
+	if (Vector3::Dot(dir, ab) < 0.0f)
+	{
+		dir = -dir;
+	}
+	if (Vector3::Dot(dir, dir) < 1e-12f)
+	{
+		dir = Vector3(0.0f, 1.0f, 0.0f);
+	}
+
+	resultAxis = dir;
+	resultAxis.Normalise();
+
+	//A pair that is still separated along the starting axis is done after this one support point
+	simplex[0] = Support(dir);
+	if (Vector3::Dot(simplex[0].p, dir) < 0.0f)
+	{
+		return false;
+	}
+	simplexSize = 1;
+	dir = -simplex[0].p;
+
+	for (unsigned int i = 0; i < GJK_MAX_ITERATIONS; ++i)
+	{
+		if (Vector3::Dot(dir, dir) < 1e-12f)
+		{
+			//The origin is on the simplex, so the shapes are at least touching. Keep building the simplex out in
+			//any direction so EPA has a tetrahedron to start from.
+			if (simplexSize == 1)
+			{
+				dir = Vector3(0.0f, 1.0f, 0.0f);
+			}
+			else if (simplexSize == 2)
+			{
+				const Vector3 line = simplex[0].p - simplex[1].p;
+				dir = Vector3::Cross(line, (fabs(line.x) < 0.57735f) ? Vector3(1.0f, 0.0f, 0.0f) : Vector3(0.0f, 1.0f, 0.0f));
+			}
+			else
+			{
+				dir = Vector3::Cross(simplex[1].p - simplex[0].p, simplex[2].p - simplex[0].p);
+			}
+		}
+
+		//If the furthest point in the search direction doesn't reach the origin then nothing on the Minkowski
+		//difference can, so that direction separates the shapes
+		const SupportPoint s = Support(dir);
+		if (Vector3::Dot(s.p, dir) < 0.0f)
+		{
+			resultAxis = dir;
+			resultAxis.Normalise();
+			return false;
+		}
+
+		simplex[simplexSize++] = s;
+
+		if (UpdateSimplex(dir))
+		{
+			//Origin is enclosed, find out how far the shapes overlap
+			if (!ExpandPolytope(bestColData))
+			{
+				return false;
+			}
+
+			if (out_coldata)
+			{
+				*out_coldata = bestColData;
+			}
+
+			resultAxis = bestColData._normal;
+			areColliding = true;
+			return true;
+		}
+	}
+
+	//Failed to converge, which only happens when the shapes are as good as touching
+	return false;
+}
+
+bool CollisionDetectionGJK::UpdateSimplex(Vector3& dir)
+{
+	switch (simplexSize)
+	{
+	case 2:
+		UpdateSimplexLine(dir);
+		return false;
+	case 3:
+		UpdateSimplexTriangle(dir);
+		return false;
+	default:
+		return UpdateSimplexTetrahedron(dir);
+	}
+}
+
+void CollisionDetectionGJK::UpdateSimplexLine(Vector3& dir)
+{
+	//A is the point just added, so the origin can't be past B
+	const SupportPoint a = simplex[1];
+	const SupportPoint b = simplex[0];
+
+	const Vector3 ab = b.p - a.p;
+	const Vector3 ao = -a.p;
+
+	if (Vector3::Dot(ab, ao) > 0.0f)
+	{
+		//Closest to the line, search perpendicular to it towards the origin
+		dir = Vector3::Cross(Vector3::Cross(ab, ao), ab);
+	}
+	else
+	{
+		//Closest to A
+		simplex[0] = a;
+		simplexSize = 1;
+		dir = ao;
+	}
+}
+
+void CollisionDetectionGJK::UpdateSimplexTriangle(Vector3& dir)
+{
+	const SupportPoint a = simplex[2];
+	const SupportPoint b = simplex[1];
+	const SupportPoint c = simplex[0];
+
+	const Vector3 ab = b.p - a.p;
+	const Vector3 ac = c.p - a.p;
+	const Vector3 ao = -a.p;
+	const Vector3 abc = Vector3::Cross(ab, ac);
+
+	if (Vector3::Dot(Vector3::Cross(abc, ac), ao) > 0.0f)
+	{
+		if (Vector3::Dot(ac, ao) > 0.0f)
+		{
+			//Closest to edge AC
+			simplex[0] = c;
+			simplex[1] = a;
+			simplexSize = 2;
+			dir = Vector3::Cross(Vector3::Cross(ac, ao), ac);
+			return;
+		}
+
+		//Closest to edge AB or point A
+		simplex[0] = b;
+		simplex[1] = a;
+		simplexSize = 2;
+		UpdateSimplexLine(dir);
+		return;
+	}
+
+	if (Vector3::Dot(Vector3::Cross(ab, abc), ao) > 0.0f)
+	{
+		//Closest to edge AB or point A
+		simplex[0] = b;
+		simplex[1] = a;
+		simplexSize = 2;
+		UpdateSimplexLine(dir);
+		return;
+	}
+
+	//Closest to the face itself, search above or below it
+	dir = (Vector3::Dot(abc, ao) > 0.0f) ? abc : -abc;
+}
+
+bool CollisionDetectionGJK::UpdateSimplexTetrahedron(Vector3& dir)
+{
+	const SupportPoint a = simplex[3];
+	const SupportPoint b = simplex[2];
+	const SupportPoint c = simplex[1];
+	const SupportPoint d = simplex[0];
+
+	const Vector3 ao = -a.p;
+
+	//The origin can't be past face BCD, as A was found searching from it towards the origin. For each of the other
+	//faces the normal is turned away from the opposite point, so the winding of the simplex doesn't matter.
+	const SupportPoint faces[3][4] = { { a, b, c, d }, { a, c, d, b }, { a, d, b, c } };
+	for (unsigned int i = 0; i < 3; ++i)
+	{
+		const SupportPoint& fa = faces[i][0];
+		const SupportPoint& fb = faces[i][1];
+		const SupportPoint& fc = faces[i][2];
+		const SupportPoint& opposite = faces[i][3];
+
+		Vector3 normal = Vector3::Cross(fb.p - fa.p, fc.p - fa.p);
+		if (Vector3::Dot(normal, opposite.p - fa.p) > 0.0f)
+		{
+			normal = -normal;
+		}
+
+		if (Vector3::Dot(normal, ao) > 0.0f)
+		{
+			//Origin is outside this face, drop the opposite point and carry on from the face
+			simplex[0] = fc;
+			simplex[1] = fb;
+			simplex[2] = fa;
+			simplexSize = 3;
+			UpdateSimplexTriangle(dir);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+
+bool CollisionDetectionGJK::ExpandPolytope(CollisionData& out_coldata)
+{
+	for (unsigned int i = 0; i < 4; ++i)
+	{
+		epaVertices[i] = simplex[i];
+	}
+	numEpaVertices = 4;
+	numEpaFaces = 0;
+
+	//Wind each face of the tetrahedron so its normal points away from the opposite vertex
+	const unsigned int tetrahedron[4][4] = { { 0, 1, 2, 3 }, { 0, 3, 1, 2 }, { 0, 2, 3, 1 }, { 1, 3, 2, 0 } };
+	for (unsigned int i = 0; i < 4; ++i)
+	{
+		const unsigned int* f = tetrahedron[i];
+		const Vector3& va = epaVertices[f[0]].p;
+		const Vector3 normal = Vector3::Cross(epaVertices[f[1]].p - va, epaVertices[f[2]].p - va);
+
+		const bool flip = Vector3::Dot(normal, epaVertices[f[3]].p - va) > 0.0f;
+		if (!AddEpaFace(f[0], flip ? f[2] : f[1], flip ? f[1] : f[2]))
+		{
+			return false;
+		}
+	}
+
+	unsigned int closest = 0;
+	for (unsigned int iteration = 0; iteration < EPA_MAX_ITERATIONS; ++iteration)
+	{
+		closest = 0;
+		for (unsigned int i = 1; i < numEpaFaces; ++i)
+		{
+			if (epaFaces[i].distance < epaFaces[closest].distance)
+			{
+				closest = i;
+			}
+		}
+
+		//If the closest face can't be pushed out any further it is on the surface of the Minkowski difference
+		const Vector3 normal = epaFaces[closest].normal;
+		const SupportPoint s = Support(normal);
+		if (Vector3::Dot(s.p, normal) - epaFaces[closest].distance < EPA_TOLERANCE
+			|| numEpaVertices == EPA_MAX_VERTICES)
+		{
+			break;
+		}
+
+		const unsigned int newVertex = numEpaVertices++;
+		epaVertices[newVertex] = s;
+
+		//Remove every face the new point can see, keeping the edges around the hole they leave
+		numEpaEdges = 0;
+		for (unsigned int i = 0; i < numEpaFaces;)
+		{
+			const EpaFace& face = epaFaces[i];
+			if (Vector3::Dot(face.normal, s.p - epaVertices[face.v[0]].p) > 0.0f)
+			{
+				AddHorizonEdge(face.v[0], face.v[1]);
+				AddHorizonEdge(face.v[1], face.v[2]);
+				AddHorizonEdge(face.v[2], face.v[0]);
+				epaFaces[i] = epaFaces[--numEpaFaces];
+			}
+			else
+			{
+				++i;
+			}
+		}
+
+		//Fill the hole by joining each edge to the new point. The edges keep the winding of the faces they came
+		//from, so the new faces face outwards. Faces with no area are skipped, the polytope is still a close enough
+		//estimate without them.
+		for (unsigned int i = 0; i < numEpaEdges; ++i)
+		{
+			AddEpaFace(epaEdges[i].a, epaEdges[i].b, newVertex);
+		}
+
+		if (numEpaFaces == 0)
+		{
+			return false;
+		}
+	}
+
+	closest = 0;
+	for (unsigned int i = 1; i < numEpaFaces; ++i)
+	{
+		if (epaFaces[i].distance < epaFaces[closest].distance)
+		{
+			closest = i;
+		}
+	}
+
+	//The contact point on A is found from the barycentric coordinates of the origin's projection onto the closest face
+	const EpaFace& face = epaFaces[closest];
+	const SupportPoint& a = epaVertices[face.v[0]];
+	const SupportPoint& b = epaVertices[face.v[1]];
+	const SupportPoint& c = epaVertices[face.v[2]];
+
+	const Vector3 v0 = b.p - a.p;
+	const Vector3 v1 = c.p - a.p;
+	const Vector3 v2 = face.normal * face.distance - a.p;
+
+	const float d00 = Vector3::Dot(v0, v0);
+	const float d01 = Vector3::Dot(v0, v1);
+	const float d11 = Vector3::Dot(v1, v1);
+	const float d20 = Vector3::Dot(v2, v0);
+	const float d21 = Vector3::Dot(v2, v1);
+	const float denom = d00 * d11 - d01 * d01;
+	if (fabs(denom) < 1e-12f)
+	{
+		return false;
+	}
+
+	const float v = (d11 * d20 - d01 * d21) / denom;
+	const float w = (d00 * d21 - d01 * d20) / denom;
+	const float u = 1.0f - v - w;
+
+	//The normal points out of the Minkowski difference (A - B), which is the direction B has to move to separate
+	out_coldata._normal = face.normal;
+	out_coldata._penetration = -max(face.distance, 0.0f);
+	out_coldata._pointOnPlane = a.a * u + b.a * v + c.a * w;
+	return true;
+}
+
+bool CollisionDetectionGJK::AddEpaFace(unsigned int a, unsigned int b, unsigned int c)
+{
+	if (numEpaFaces == EPA_MAX_FACES)
+	{
+		return false;
+	}
+
+	const Vector3& va = epaVertices[a].p;
+	Vector3 normal = Vector3::Cross(epaVertices[b].p - va, epaVertices[c].p - va);
+	const float length = normal.Length();
+	if (length < 1e-10f)
+	{
+		return false;
+	}
+
+	EpaFace& face = epaFaces[numEpaFaces++];
+	face.v[0] = a;
+	face.v[1] = b;
+	face.v[2] = c;
+	face.normal = normal / length;
+	face.distance = Vector3::Dot(face.normal, va);
+	return true;
+}
+
+void CollisionDetectionGJK::AddHorizonEdge(unsigned int a, unsigned int b)
+{
+	//Neighbouring faces go around their shared edge in opposite directions
+	for (unsigned int i = 0; i < numEpaEdges; ++i)
+	{
+		if (epaEdges[i].a == b && epaEdges[i].b == a)
+		{
+			epaEdges[i] = epaEdges[--numEpaEdges];
+			return;
+		}
+	}
+
+	if (numEpaEdges < EPA_MAX_EDGES)
+	{
+		epaEdges[numEpaEdges].a = a;
+		epaEdges[numEpaEdges].b = b;
+		numEpaEdges++;
+	}
+}
+
+
+
+void CollisionDetectionGJK::GenContactPoints(Manifold* out_manifold)
+{
+	if (!out_manifold || !areColliding)
+	{
+		return;
+	}
+
+	const unsigned int numContacts = out_manifold->GetNumContacts();
+	CollisionDispatch::GenClippedContactPoints(cshapeA, cshapeB, bestColData, arena, out_manifold);
+
+	//Clipping finds nothing if the faces around the normal don't overlap, so fall back to the point found by EPA
+	if (out_manifold->GetNumContacts() == numContacts && bestColData._penetration < 0.0f)
+	{
+		CollisionDispatch::GenContactPoint(bestColData, out_manifold);
+	}
+}
@@ -0,0 +1,151 @@
+/******************************************************************************
+Class: CollisionDetectionGJK
+Implements:
+Author:
+	Pieran Marris <p.marris@newcastle.ac.uk> and YOU!
+Description:
+
+	Alternative to CollisionDetectionSAT for any two convex collision shapes, using
+	the Gilbert-Johnson-Keerthi (GJK) algorithm to detect if a collision occured and
+	the Expanding Polytope Algorithm (EPA) to find the penetration depth and normal.
+
+	Both algorithms work on the Minkowski difference of the two shapes (every point
+	on A minus every point on B), which contains the origin only if the shapes overlap.
+	They never build the Minkowski difference itself, it is explored one point at a
+	time through each shape's support function (CollisionShape::GetSupportPoint), so
+	the cost grows with the number of iterations rather than with faces x edges like SAT.
+
+		GJK
+		 - Builds a simplex (point, line, triangle then tetrahedron) of points on the
+		   Minkowski difference, each time searching towards the origin from the part
+		   of the simplex closest to it. If a search can't get past the origin then
+		   that direction separates the shapes, otherwise it ends with a tetrahedron
+		   that encloses the origin.
+
+		EPA
+		 - Starting from GJK's tetrahedron, repeatedly pushes the face closest to the
+		   origin out to the surface of the Minkowski difference until it can't go any
+		   further. That face's normal and distance from the origin are then the
+		   collision normal and penetration depth.
+
+	The contact points are built by clipping the two shapes' faces around the EPA normal,
+	the same as CollisionDetectionSAT, falling back to the single point found by EPA for
+	curved shapes. Everything is held in fixed size arrays so detection never allocates.
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "PhysicsNode.h"
+#include "CollisionShape.h"
+#include "CollisionDetectionSAT.h"
+#include "Manifold.h"
+
+#define GJK_MAX_ITERATIONS 64
+#define EPA_MAX_ITERATIONS 32
+#define EPA_MAX_VERTICES (4 + EPA_MAX_ITERATIONS)
+#define EPA_MAX_FACES 128
+#define EPA_MAX_EDGES (EPA_MAX_FACES * 3)		//Edges of removed faces can be added before the face on their other side cancels them out
+#define EPA_TOLERANCE 0.0001f		//EPA stops once the closest face moves out by less than this (m)
+
+class CollisionDetectionGJK
+{
+public:
+	//Temporary data for contact clipping is taken from the given arena, or the heap if there isn't one
+	CollisionDetectionGJK(FrameArena* arena = NULL);
+
+	//Start processing new (possible) collision pair
+	// - If given, the cached axis is used as the first search direction. Passing the axis returned by
+	//   GetResultAxis for the same pair last step means a pair that is still separated normally only
+	//   needs a single support point.
+	void BeginNewPair(
+		PhysicsNode* objA,
+		PhysicsNode* objB,
+		CollisionShape* shapeA,
+		CollisionShape* shapeB,
+		const Vector3* cachedAxis = NULL);
+
+	// GJK, followed by EPA if the shapes overlap
+	// - Returns true if the objects are colliding or false otherwise
+	bool AreColliding(CollisionData* out_coldata = NULL);
+
+	// The direction that separated the pair, or the collision normal if they are colliding
+	inline const Vector3& GetResultAxis() const { return resultAxis; }
+
+	// Builds the contact points around the collision normal found by EPA
+	void GenContactPoints(Manifold* out_manifold);
+
+protected:
+	//Point on the Minkowski difference, along with the points on each shape it came from
+	struct SupportPoint
+	{
+		Vector3	p;
+		Vector3	a;
+		Vector3	b;
+	};
+
+	//Furthest point on the Minkowski difference in the given direction
+	SupportPoint Support(const Vector3& dir) const;
+
+//<---- GJK ---->
+	//Reduces the simplex to the part closest to the origin and picks the next search direction
+	// - Returns true once the simplex is a tetrahedron containing the origin
+	bool UpdateSimplex(Vector3& dir);
+	void UpdateSimplexLine(Vector3& dir);
+	void UpdateSimplexTriangle(Vector3& dir);
+	bool UpdateSimplexTetrahedron(Vector3& dir);
+
+//<---- EPA ---->
+	struct EpaFace
+	{
+		unsigned int	v[3];		//Vertices, counter clockwise when looking at the outside of the polytope
+		Vector3			normal;		//Points out of the polytope
+		float			distance;	//Distance from the origin along the normal
+	};
+
+	struct EpaEdge
+	{
+		unsigned int	a;
+		unsigned int	b;
+	};
+
+	//Expands the tetrahedron left by GJK to find the penetration depth and normal
+	// - Returns false if the polytope is degenerate, which only happens if the shapes are just touching
+	bool ExpandPolytope(CollisionData& out_coldata);
+
+	//Adds a face to the polytope, returns false if there is no room or the face has no area
+	bool AddEpaFace(unsigned int a, unsigned int b, unsigned int c);
+
+	//Adds an edge of a removed face to the horizon, or removes it if the face on its other side was already removed
+	void AddHorizonEdge(unsigned int a, unsigned int b);
+
+private:
+	//Physics Nodes
+	const PhysicsNode*		pnodeA;
+	const PhysicsNode*		pnodeB;
+
+	//Collision shapes
+	const CollisionShape*	cshapeA;
+	const CollisionShape*	cshapeB;
+
+	//Temporary allocations for the current physics update
+	FrameArena*				arena;
+
+	//GJK simplex, oldest point first
+	SupportPoint			simplex[4];
+	unsigned int			simplexSize;
+
+	//EPA polytope
+	SupportPoint			epaVertices[EPA_MAX_VERTICES];
+	unsigned int			numEpaVertices;
+	EpaFace					epaFaces[EPA_MAX_FACES];
+	unsigned int			numEpaFaces;
+	EpaEdge					epaEdges[EPA_MAX_EDGES];
+	unsigned int			numEpaEdges;
+
+	bool					hasCachedAxis;
+	Vector3					cachedAxis;
+	Vector3					resultAxis;
+
+	//Collision Data
+	bool					areColliding;
+	CollisionData			bestColData;
+};
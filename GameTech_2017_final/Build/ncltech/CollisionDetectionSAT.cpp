@@ -1,10 +1,14 @@
 #include "CollisionDetectionSAT.h"
-#include <nclgl\NCLDebug.h>
+#include <nclgl/NCLDebug.h>
 #include "GeometryUtils.h"
+#include "CollisionDispatch.h"
 
 using namespace GeometryUtils;
 
-CollisionDetectionSAT::CollisionDetectionSAT()
+CollisionDetectionSAT::CollisionDetectionSAT(FrameArena* arena)
+	: arena(arena)
+	, numPossibleColAxes(0)
+	, hasCachedAxis(false)
 {
 }
 
@@ -12,9 +16,16 @@ void CollisionDetectionSAT::BeginNewPair(
 	PhysicsNode* obj1,
 	PhysicsNode* obj2,
 	CollisionShape* shape1,
-	CollisionShape* shape2)
+	CollisionShape* shape2,
+	const Vector3* cached)
 {
-	possibleColAxes.clear();
+	numPossibleColAxes = 0;
+
+	hasCachedAxis = (cached != NULL);
+	if (cached)
+	{
+		cachedAxis = *cached;
+	}
 
 	pnodeA = obj1;
 	pnodeB = obj2;
@@ -34,12 +45,24 @@ bool CollisionDetectionSAT::AreColliding(CollisionData* out_coldata)
 	}
 
 	areColliding = false;
-	possibleColAxes.clear();
+	numPossibleColAxes = 0;
+
+	CollisionData cur_colData;
+
+	//<----- CACHED AXIS ----->
+	//Pairs tend to be separated (or collide) along the same axis from one step to the next, so if the axis that
+	//separated them last step still does the pair can be rejected without building any other axes
+
+	if (hasCachedAxis && !CheckCollisionAxis(cachedAxis, cur_colData))
+	{
+		resultAxis = cachedAxis;
+		return false;
+	}
 
 	//<----- DEFAULT AXES ----->
 	//GetCollisionAxes takes in the /other/ object as a parameter here
 
-	std::vector<Vector3> axes1, axes2;
+	CollisionAxes axes1, axes2;
 
 	cshapeA->GetCollisionAxes(pnodeB, axes1);
 	for (const Vector3& axis : axes1)
@@ -81,17 +104,18 @@ bool CollisionDetectionSAT::AreColliding(CollisionData* out_coldata)
 	//either return false, or return the best axis (one with the
 	//least penetration) found.
 
-	CollisionData cur_colData;
-
 	bestColData._penetration = -FLT_MAX;
-	for (const Vector3& axis : possibleColAxes)
+	for (unsigned int i = 0; i < numPossibleColAxes; ++i)
 	{
+		const Vector3& axis = possibleColAxes[i];
+
 		//If the collision axis does NOT intersect then return
 		//immediately as we know that at least in one direction/axis
 		//the two objects do not intersect
 
 		if (!CheckCollisionAxis(axis, cur_colData))
 		{
+			resultAxis = axis;
 			return false;
 		}
 
@@ -106,6 +130,7 @@ bool CollisionDetectionSAT::AreColliding(CollisionData* out_coldata)
 		*out_coldata = bestColData;
 	}
 
+	resultAxis = bestColData._normal;
 	areColliding = true;
 	return true;
 
@@ -182,113 +207,7 @@ void CollisionDetectionSAT::GenContactPoints(Manifold* out_manifold)
 		return;
 	}
 
-	if (bestColData._penetration >= 0.0f)
-	{
-		return;
-	}
-
-	//Get the required face information for the two shapes around the collision normal
-
-	std::list<Vector3> polygon1, polygon2;
-	Vector3 normal1, normal2;
-	std::vector<Plane> adjPlanes1, adjPlanes2;
-
-	cshapeA->GetIncidentReferencePolygon(bestColData._normal, polygon1, normal1, adjPlanes1);
-	cshapeB->GetIncidentReferencePolygon(-bestColData._normal, polygon2, normal2, adjPlanes2);
-
-	//If either shape1 or shape2 returned a single point, then it must be on a curve and thus
-	//the only contact point to generate is already available
-
-	if (polygon1.size() == 0 || polygon2.size() == 0)
-	{
-		return;	//No points returned, resulting in no possible contact points
-	}
-	else if (polygon1.size() == 1)
-	{
-		out_manifold->AddContact(
-			polygon1.front(),			//Polygon1 -> Polygon2
-			polygon1.front() + bestColData._normal * bestColData._penetration,
-			bestColData._normal,
-			bestColData._penetration);
-	}
-	else if (polygon2.size() == 1)
-	{
-		out_manifold->AddContact(
-			polygon2.front() - bestColData._normal * bestColData._penetration,
-			polygon2.front(),			//Polygon2 <- Polygon1
-			bestColData._normal,
-			bestColData._penetration);
-	}
-	else
-	{
-		//Otherwise use clipping to cut down the incident face to fit
-		//inside the reference planes using the surrounding face planes
-
-		//First we need to know if we have to flip the incident and
-		//reference faces around for clipping
-
-		bool flipped = fabs(Vector3::Dot(bestColData._normal, normal1)) <
-			fabs(Vector3::Dot(bestColData._normal, normal2));
-
-		if (flipped)
-		{
-			std::swap(polygon1, polygon2);
-			std::swap(normal1, normal2);
-			std::swap(adjPlanes1, adjPlanes2);
-		}
-
-		//Clip the incident face to the adjacent edges of the reference face
-
-		if (adjPlanes1.size() > 0)
-		{
-			SutherlandHodgmanClipping(polygon2, adjPlanes1.size(),
-				&adjPlanes1[0], &polygon2, false);
-		}
-
-		//Finally clip (and remove) any contact points that are above the reference face
-
-		Plane refPlane = Plane(-normal1, -Vector3::Dot(-normal1, polygon1.front()));
-		SutherlandHodgmanClipping(polygon2, 1, &refPlane, &polygon2, true);
-
-		//Now we are left with a selection of valid contact points to be used for the manifold
-
-		for (const Vector3& point : polygon2)
-		{
-			//Compute distance to reference place
-
-			Vector3 pointDiff = point - GetClosestPointPolygon(point, polygon1);
-			float contact_penetration = Vector3::Dot(pointDiff, bestColData._normal);
-
-			//Set contact data
-
-			Vector3 globalOnA = point;
-			Vector3 globalOnB = point - bestColData._normal * contact_penetration;
-
-			//If we flipped incident and reference planes, we will need to flip it back before
-			//sending it to the manifold. e.g. turn it from talking about object2->object1 into
-			//object1->object2
-
-			if (flipped)
-			{
-				contact_penetration = -contact_penetration;
-				globalOnA = point + bestColData._normal * contact_penetration;
-
-				globalOnB = point;
-			}
-
-			//Just make a final sanity check that the contact point is actually a point of
-			//contact not just a clipping bug
-
-			if (contact_penetration < 0.0f)
-			{
-				out_manifold->AddContact(
-					globalOnA,
-					globalOnB,
-					bestColData._normal,
-					contact_penetration);
-			}
-		}
-	}
+	CollisionDispatch::GenClippedContactPoints(cshapeA, cshapeB, bestColData, arena, out_manifold);
 }
 
 
@@ -317,14 +236,14 @@ bool CollisionDetectionSAT::AddPossibleCollisionAxis(Vector3 axis)
 
 	axis.Normalise();
 
-	for (const Vector3& p_axis : possibleColAxes)
+	for (unsigned int i = 0; i < numPossibleColAxes; ++i)
 	{
 		//Is axis very close to the same as a previous axis already in the list of axes??
-		if (Vector3::Dot(axis, p_axis) >= 1.0f - epsilon)
+		if (Vector3::Dot(axis, possibleColAxes[i]) >= 1.0f - epsilon)
 			return false;
 	}
 
-	possibleColAxes.push_back(axis);
+	possibleColAxes[numPossibleColAxes++] = axis;
 	return true;
 }
 
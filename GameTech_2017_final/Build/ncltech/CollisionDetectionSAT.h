@@ -54,20 +54,27 @@ struct CollisionData
 class CollisionDetectionSAT
 {
 public:
-	CollisionDetectionSAT();
+	//Temporary data for each pair is taken from the given arena, or the heap if there isn't one
+	CollisionDetectionSAT(FrameArena* arena = NULL);
 
 	//Start processing new (possible) collision pair
 	// - Clear all previous collision data
+	// - If given, the cached axis is tested before any others. Passing the axis returned by GetResultAxis for the
+	//   same pair last step means a pair that is still separated normally only needs a single projection.
 	void BeginNewPair(
 		PhysicsNode* objA,
 		PhysicsNode* objB,
 		CollisionShape* shapeA,
-		CollisionShape* shapeB);
+		CollisionShape* shapeB,
+		const Vector3* cachedAxis = NULL);
 
 	// Seperating-Axis-Theorem
 	// - Returns true if the objects are colliding or false otherwise
 	bool AreColliding(CollisionData* out_coldata = NULL);
 
+	// The axis that separated the pair, or the axis with the least penetration if they are colliding
+	inline const Vector3& GetResultAxis() const { return resultAxis; }
+
 	// Clipping Method
 	// - Uses clipping to construct a manifold describing the surface area
 	//   of the collision region
@@ -92,8 +99,17 @@ private:
 	const CollisionShape*	cshapeA;
 	const CollisionShape*	cshapeB;
 
+	//Temporary allocations for the current physics update
+	FrameArena*				arena;
+
 	//Collision Axes
-	std::vector<Vector3>	possibleColAxes;
+	// - Each shape's own axes, plus the cross product of every pair of them
+	Vector3					possibleColAxes[SAT_MAX_SHAPE_AXES * 2 + SAT_MAX_SHAPE_AXES * SAT_MAX_SHAPE_AXES];
+	unsigned int			numPossibleColAxes;
+
+	bool					hasCachedAxis;
+	Vector3					cachedAxis;
+	Vector3					resultAxis;
 
 	//Collision Data
 	bool					areColliding;
@@ -0,0 +1,241 @@
+#include "CollisionDispatch.h"
+#include "SphereCollisionShape.h"
+#include "CuboidCollisionShape.h"
+#include "GeometryUtils.h"
+
+using namespace GeometryUtils;
+
+//Indexed by [shape A type][shape B type]
+const CollisionTestFunc CollisionDispatch::testTable[COLLISION_SHAPE_MAX][COLLISION_SHAPE_MAX] =
+{
+	//Sphere						//Cuboid							//Convex Hull
+	{ &CollisionDispatch::SphereSphere,	&CollisionDispatch::SphereCuboid,	NULL },	//Sphere
+	{ &CollisionDispatch::CuboidSphere,	NULL,								NULL },	//Cuboid
+	{ NULL,								NULL,								NULL },	//Convex Hull
+};
+
+void CollisionDispatch::GenContactPoint(const CollisionData& coldata, Manifold* out_manifold)
+{
+	out_manifold->AddContact(
+		coldata._pointOnPlane,
+		coldata._pointOnPlane + coldata._normal * coldata._penetration,
+		coldata._normal,
+		coldata._penetration);
+}
+
+void CollisionDispatch::GenClippedContactPoints(
+	const CollisionShape* shapeA,
+	const CollisionShape* shapeB,
+	const CollisionData& coldata,
+	FrameArena* arena,
+	Manifold* out_manifold)
+{
+	if (coldata._penetration >= 0.0f)
+	{
+		return;
+	}
+
+	//Get the required face information for the two shapes around the collision normal
+
+	ArenaList<Vector3> polygon1(arena), polygon2(arena);
+	Vector3 normal1, normal2;
+	ArenaVector<Plane> adjPlanes1(arena), adjPlanes2(arena);
+
+	shapeA->GetIncidentReferencePolygon(coldata._normal, polygon1, normal1, adjPlanes1);
+	shapeB->GetIncidentReferencePolygon(-coldata._normal, polygon2, normal2, adjPlanes2);
+
+	//If either shape1 or shape2 returned a single point, then it must be on a curve and thus
+	//the only contact point to generate is already available
+
+	if (polygon1.size() == 0 || polygon2.size() == 0)
+	{
+		return;	//No points returned, resulting in no possible contact points
+	}
+	else if (polygon1.size() == 1)
+	{
+		out_manifold->AddContact(
+			polygon1.front(),			//Polygon1 -> Polygon2
+			polygon1.front() + coldata._normal * coldata._penetration,
+			coldata._normal,
+			coldata._penetration);
+	}
+	else if (polygon2.size() == 1)
+	{
+		out_manifold->AddContact(
+			polygon2.front() - coldata._normal * coldata._penetration,
+			polygon2.front(),			//Polygon2 <- Polygon1
+			coldata._normal,
+			coldata._penetration);
+	}
+	else
+	{
+		//Otherwise use clipping to cut down the incident face to fit
+		//inside the reference planes using the surrounding face planes
+
+		//First we need to know if we have to flip the incident and
+		//reference faces around for clipping
+
+		bool flipped = fabs(Vector3::Dot(coldata._normal, normal1)) <
+			fabs(Vector3::Dot(coldata._normal, normal2));
+
+		if (flipped)
+		{
+			std::swap(polygon1, polygon2);
+			std::swap(normal1, normal2);
+			std::swap(adjPlanes1, adjPlanes2);
+		}
+
+		//Clip the incident face to the adjacent edges of the reference face
+
+		if (adjPlanes1.size() > 0)
+		{
+			SutherlandHodgmanClipping(polygon2, adjPlanes1.size(),
+				&adjPlanes1[0], &polygon2, false);
+		}
+
+		//Finally clip (and remove) any contact points that are above the reference face
+
+		Plane refPlane = Plane(-normal1, -Vector3::Dot(-normal1, polygon1.front()));
+		SutherlandHodgmanClipping(polygon2, 1, &refPlane, &polygon2, true);
+
+		//Now we are left with a selection of valid contact points to be used for the manifold
+
+		for (const Vector3& point : polygon2)
+		{
+			//Compute distance to reference place
+
+			Vector3 pointDiff = point - GetClosestPointPolygon(point, polygon1);
+			float contact_penetration = Vector3::Dot(pointDiff, coldata._normal);
+
+			//Set contact data
+
+			Vector3 globalOnA = point;
+			Vector3 globalOnB = point - coldata._normal * contact_penetration;
+
+			//If we flipped incident and reference planes, we will need to flip it back before
+			//sending it to the manifold. e.g. turn it from talking about object2->object1 into
+			//object1->object2
+
+			if (flipped)
+			{
+				contact_penetration = -contact_penetration;
+				globalOnA = point + coldata._normal * contact_penetration;
+
+				globalOnB = point;
+			}
+
+			//Just make a final sanity check that the contact point is actually a point of
+			//contact not just a clipping bug
+
+			if (contact_penetration < 0.0f)
+			{
+				out_manifold->AddContact(
+					globalOnA,
+					globalOnB,
+					coldata._normal,
+					contact_penetration);
+			}
+		}
+	}
+}
+
+bool CollisionDispatch::SphereSphere(const PhysicsNode* pnodeA, const PhysicsNode* pnodeB, CollisionData& out_coldata)
+{
+	const float radiusA = static_cast<const SphereCollisionShape*>(pnodeA->GetCollisionShape())->GetRadius();
+	const float radiusB = static_cast<const SphereCollisionShape*>(pnodeB->GetCollisionShape())->GetRadius();
+	const float radiusSum = radiusA + radiusB;
+
+	const Vector3 ab = pnodeB->GetPosition() - pnodeA->GetPosition();
+	const float distSq = Vector3::Dot(ab, ab);
+	if (distSq >= radiusSum * radiusSum)
+	{
+		return false;
+	}
+
+	//Spheres with the same centre have no preferred direction so just push them apart vertically
+	const float dist = sqrtf(distSq);
+	out_coldata._normal = (dist > 1e-6f) ? ab / dist : Vector3(0.0f, 1.0f, 0.0f);
+	out_coldata._penetration = dist - radiusSum;
+	out_coldata._pointOnPlane = pnodeA->GetPosition() + out_coldata._normal * radiusA;
+	return true;
+}
+
+bool CollisionDispatch::SphereCuboid(const PhysicsNode* pnodeA, const PhysicsNode* pnodeB, CollisionData& out_coldata)
+{
+	const float radius = static_cast<const SphereCollisionShape*>(pnodeA->GetCollisionShape())->GetRadius();
+	const Vector3& halfDims = static_cast<const CuboidCollisionShape*>(pnodeB->GetCollisionShape())->GetHalfDims();
+
+	//The columns of the cuboid's world transform are its local axes
+	const Matrix4& transform = pnodeB->GetWorldSpaceTransform();
+	const Vector3 axisX = Vector3(transform[0], transform[1], transform[2]);
+	const Vector3 axisY = Vector3(transform[4], transform[5], transform[6]);
+	const Vector3 axisZ = Vector3(transform[8], transform[9], transform[10]);
+
+	//Sphere centre in the cuboid's local space
+	const Vector3 rel = pnodeA->GetPosition() - pnodeB->GetPosition();
+	const Vector3 local = Vector3(Vector3::Dot(rel, axisX), Vector3::Dot(rel, axisY), Vector3::Dot(rel, axisZ));
+
+	Vector3 closest = Vector3(
+		min(max(local.x, -halfDims.x), halfDims.x),
+		min(max(local.y, -halfDims.y), halfDims.y),
+		min(max(local.z, -halfDims.z), halfDims.z));
+
+	Vector3 localNormal;		//Cuboid -> sphere, in local space
+	float dist;					//Distance from the cuboid's surface to the sphere's centre, negative if inside
+
+	const Vector3 diff = local - closest;
+	const float distSq = Vector3::Dot(diff, diff);
+	if (distSq > 0.0f)
+	{
+		//Centre is outside the cuboid, the closest point is on the surface
+		if (distSq >= radius * radius)
+		{
+			return false;
+		}
+
+		dist = sqrtf(distSq);
+		localNormal = diff / dist;
+	}
+	else
+	{
+		//Centre is inside the cuboid, push it out through the nearest face
+		const Vector3 faceDist = halfDims - Vector3(fabs(local.x), fabs(local.y), fabs(local.z));
+		if (faceDist.x <= faceDist.y && faceDist.x <= faceDist.z)
+		{
+			localNormal = Vector3(local.x < 0.0f ? -1.0f : 1.0f, 0.0f, 0.0f);
+			closest.x = localNormal.x * halfDims.x;
+			dist = -faceDist.x;
+		}
+		else if (faceDist.y <= faceDist.z)
+		{
+			localNormal = Vector3(0.0f, local.y < 0.0f ? -1.0f : 1.0f, 0.0f);
+			closest.y = localNormal.y * halfDims.y;
+			dist = -faceDist.y;
+		}
+		else
+		{
+			localNormal = Vector3(0.0f, 0.0f, local.z < 0.0f ? -1.0f : 1.0f);
+			closest.z = localNormal.z * halfDims.z;
+			dist = -faceDist.z;
+		}
+	}
+
+	//Normal goes from A (sphere) to B (cuboid)
+	out_coldata._normal = -(axisX * localNormal.x + axisY * localNormal.y + axisZ * localNormal.z);
+	out_coldata._penetration = dist - radius;
+	out_coldata._pointOnPlane = pnodeA->GetPosition() + out_coldata._normal * radius;
+	return true;
+}
+
+bool CollisionDispatch::CuboidSphere(const PhysicsNode* pnodeA, const PhysicsNode* pnodeB, CollisionData& out_coldata)
+{
+	if (!SphereCuboid(pnodeB, pnodeA, out_coldata))
+	{
+		return false;
+	}
+
+	//Flip the result so it goes from A (cuboid) to B (sphere), with the point on plane on the cuboid
+	out_coldata._pointOnPlane = out_coldata._pointOnPlane + out_coldata._normal * out_coldata._penetration;
+	out_coldata._normal = -out_coldata._normal;
+	return true;
+}
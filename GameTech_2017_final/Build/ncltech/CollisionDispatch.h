@@ -0,0 +1,57 @@
+#pragma once
+
+#include "PhysicsNode.h"
+#include "CollisionDetectionSAT.h"
+
+//Narrowphase collision tests picked by the types of the two collision shapes
+//
+//Pairs of shapes with a simple closed form test (sphere-sphere and sphere-cuboid) skip the general SAT test and
+//its clipping entirely, as they can only ever have a single contact point. Any pair without an entry in the
+//table falls back to CollisionDetectionSAT, or CollisionDetectionGJK if either shape is a convex hull.
+//
+//Each test fills in the collision data in the same form as CollisionDetectionSAT: the normal points from
+//object A to object B, the penetration is negative and the point on plane is the contact point on object A.
+
+//Returns true and fills in the collision data if the two objects overlap
+typedef bool(*CollisionTestFunc)(const PhysicsNode* pnodeA, const PhysicsNode* pnodeB, CollisionData& out_coldata);
+
+class CollisionDispatch
+{
+public:
+	//Returns the closed form test for the given pair of shapes, or NULL if the pair has to use SAT
+	static inline CollisionTestFunc GetCollisionTest(const CollisionShape* shapeA, const CollisionShape* shapeB)
+	{
+		return testTable[shapeA->GetType()][shapeB->GetType()];
+	}
+
+	//Returns true if the pair has to use GJK whichever narrowphase is selected
+	// - Convex hulls can have more face normals and edges than SAT has room for
+	static inline bool RequiresGJK(const CollisionShape* shapeA, const CollisionShape* shapeB)
+	{
+		return shapeA->GetType() == COLLISION_SHAPE_CONVEXHULL
+			|| shapeB->GetType() == COLLISION_SHAPE_CONVEXHULL;
+	}
+
+	//Adds the single contact point described by the collision data to the manifold
+	static void GenContactPoint(const CollisionData& coldata, Manifold* out_manifold);
+
+	//Builds the contact points for a collision between two shapes with the given normal, by clipping the incident
+	// face of one shape against the reference face of the other (see CollisionShape::GetIncidentReferencePolygon)
+	// - Used by both CollisionDetectionSAT and CollisionDetectionGJK, temporary polygons come from the arena
+	static void GenClippedContactPoints(
+		const CollisionShape* shapeA,
+		const CollisionShape* shapeB,
+		const CollisionData& coldata,
+		FrameArena* arena,
+		Manifold* out_manifold);
+
+	static bool SphereSphere(const PhysicsNode* pnodeA, const PhysicsNode* pnodeB, CollisionData& out_coldata);
+
+	//Closest point on the cuboid to the sphere's centre, found by clamping the centre to the half dimensions in
+	//the cuboid's local space
+	static bool SphereCuboid(const PhysicsNode* pnodeA, const PhysicsNode* pnodeB, CollisionData& out_coldata);
+	static bool CuboidSphere(const PhysicsNode* pnodeA, const PhysicsNode* pnodeB, CollisionData& out_coldata);
+
+protected:
+	static const CollisionTestFunc testTable[COLLISION_SHAPE_MAX][COLLISION_SHAPE_MAX];
+};
@@ -9,7 +9,8 @@ Description:
 
 	This will be the only thing in the physics engine that defines the geometric shape of the
 	attached PhysicsNode. It provides a means for computing the interia tensor (rotational mass)
-	and a means to calculate collisions with other unknown collision shapes via CollisionDetectionSAT.
+	and a means to calculate collisions with other unknown collision shapes via CollisionDetectionSAT
+	or CollisionDetectionGJK.
 
 	For example usage, see SphereCollisionShape (implicit shape defined by an algorithm - in this case bounding radius)
 	and CuboidCollisionShape (physical shape defined by a set of vertices/faces)
@@ -20,9 +21,10 @@ Description:
 
 #include "Hull.h"
 #include "GeometryUtils.h"
-#include <nclgl\Vector3.h>
-#include <nclgl\Plane.h>
-#include <nclgl\Matrix3.h>
+#include "BoundingBox.h"
+#include <nclgl/Vector3.h>
+#include <nclgl/Plane.h>
+#include <nclgl/Matrix3.h>
 #include <vector>
 #include <list>
 
@@ -30,6 +32,35 @@ using namespace GeometryUtils;
 
 class PhysicsNode;
 
+//Type of each collision shape, used to pick a specialised collision test for a pair of shapes (see CollisionDispatch)
+enum CollisionShapeType
+{
+	COLLISION_SHAPE_SPHERE = 0,
+	COLLISION_SHAPE_CUBOID,
+	COLLISION_SHAPE_CONVEXHULL,
+	COLLISION_SHAPE_MAX
+};
+
+#define SAT_MAX_SHAPE_AXES 8		//Most collision axes any one shape can give the SAT test
+
+//Fixed size list of collision axes, so the SAT test never has to allocate
+struct CollisionAxes
+{
+	CollisionAxes() : count(0) {}
+
+	//Axes past the capacity are ignored
+	inline void Add(const Vector3& axis)
+	{
+		if (count < SAT_MAX_SHAPE_AXES) axes[count++] = axis;
+	}
+
+	inline const Vector3* begin() const { return axes; }
+	inline const Vector3* end() const { return axes + count; }
+
+	Vector3			axes[SAT_MAX_SHAPE_AXES];
+	unsigned int	count;
+};
+
 struct CollisionEdge
 {
 	CollisionEdge(const Vector3& a, const Vector3& b) 
@@ -45,10 +76,16 @@ public:
 	CollisionShape() : m_Parent(NULL) {}
 	virtual ~CollisionShape()	{}
 
+	virtual CollisionShapeType GetType() const = 0;
+
 	// Constructs an inverse inertia matrix of the given collision volume. This is the equivilant of the inverse mass of an object for rotation,
 	//   a good source for non-inverse inertia matricies can be found here: https://en.wikipedia.org/wiki/List_of_moments_of_inertia
 	virtual Matrix3 BuildInverseInertia(float invMass) const = 0;
 
+	// Computes the tight world space AABB of the shape from the parent's current transform.
+	//   This is cached by PhysicsNode whenever it moves, so the broadphase never has to call it directly.
+	virtual BoundingBox BuildWorldSpaceAABB() const = 0;
+
 	// Draws this collision shape to the debug renderer
 	virtual void DebugDraw() const {};
 
@@ -63,11 +100,17 @@ public:
 	// the other shape will also have it's own axes to test.
 	virtual void GetCollisionAxes(
 		const PhysicsNode* otherObject,
-		std::vector<Vector3>& out_axes) const = 0;
+		CollisionAxes& out_axes) const = 0;
 
 	//Returns closest point on the collision shape to the given point
 	virtual Vector3 GetClosestPoint(const Vector3& point) const = 0;
 
+	// Get the world space point on the shape furthest along the given direction
+	//	- The direction doesn't have to be normalised
+	//	- This is all CollisionDetectionGJK needs to know about a shape, so any convex shape
+	//	  with a support function can be collided without building a list of axes
+	virtual Vector3 GetSupportPoint(const Vector3& dir) const = 0;
+
 	// Get the min/max vertices along a given axis
 	virtual void GetMinMaxVertexOnAxis(
 		const Vector3& axis, 
@@ -81,9 +124,9 @@ public:
 	//    of all adjacent faces in order to clip against.
 	virtual void GetIncidentReferencePolygon(
 		const Vector3& axis,
-		std::list<Vector3>& out_face,
+		ArenaList<Vector3>& out_face,
 		Vector3& out_normal,
-		std::vector<Plane>& out_adjacent_planes) const = 0;
+		ArenaVector<Plane>& out_adjacent_planes) const = 0;
 
 protected:
 	PhysicsNode* m_Parent;
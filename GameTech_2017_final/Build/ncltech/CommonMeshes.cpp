@@ -1,6 +1,6 @@
 #include "CommonMeshes.h"
-#include <nclgl\NCLDebug.h>
-#include <nclgl\OBJMesh.h>
+#include <nclgl/NCLDebug.h>
+#include <nclgl/OBJMesh.h>
 #include <SOIL.h>
 #include "GraphicsPipeline.h"
 
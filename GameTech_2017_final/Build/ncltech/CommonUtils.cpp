@@ -1,9 +1,10 @@
 #include "CommonUtils.h"
 #include "SphereCollisionShape.h"
 #include "CuboidCollisionShape.h"
+#include "ConvexHullCollisionShape.h"
 #include "CommonMeshes.h"
 #include "ScreenPicker.h"
-#include <nclgl\RenderNode.h>
+#include <nclgl/RenderNode.h>
 #include <functional>
 
 //Horrible!!!
@@ -16,7 +17,7 @@ void CommonUtils::DragableObjectCallback(GameObject* obj, float dt, const Vector
 {
 	if (obj->HasPhysics())
 	{
-		obj->Physics()->SetAtRest(false);
+		obj->Physics()->WakeUp();
 		if (Window::GetMouse()->ButtonDown(MOUSE_LEFT))
 		{
 			//Position
@@ -47,9 +48,8 @@ void CommonUtils::DragableObjectCallback(GameObject* obj, float dt, const Vector
 
 			obj->Physics()->SetInverseInertia(dragDataInertia);
 			obj->Physics()->SetInverseMass(dragDataMass);
-			//Ensure that all previous frame velocities are > 0 to avoid the object getting stuck in
-			//other objects after being dragged
-			obj->Physics()->ResetVelocities();
+			//Make sure the object doesn't go straight back to sleep and get stuck in other objects after being dragged
+			obj->Physics()->WakeUp();
 		}
 		else if(!dragDataSet)
 		{
@@ -215,3 +215,62 @@ GameObject* CommonUtils::BuildCuboidObject(
 	
 	return obj;
 }
+
+GameObject* CommonUtils::BuildConvexHullObject(
+	const std::string& name,
+	const Vector3& pos,
+	Mesh* mesh,
+	const Vector3& scale,
+	bool physics_enabled,
+	float inverse_mass,
+	bool collidable,
+	bool dragable,
+	const Vector4& color)
+{
+	//The hull is needed for the bounding radius (and inertia) even if the object can't collide
+	ConvexHullCollisionShape* pColshape = new ConvexHullCollisionShape(mesh, scale);
+	float radius = pColshape->GetBoundingRadius();
+
+	//The hull is centred on its centre of mass, so the object goes there and the mesh is moved back to line up with it
+	const Vector3 centreOfMass = pColshape->GetCentreOfMass();
+	const Vector3 centre = pos + centreOfMass;
+
+	//Same dummy/parent node setup as BuildCuboidObject
+	RenderNode* rnode = new RenderNode();
+
+	RenderNode* dummy = new RenderNode(mesh, color);
+	dummy->SetTransform(Matrix4::Translation(-centreOfMass) * Matrix4::Scale(scale));
+	rnode->AddChild(dummy);
+
+	rnode->SetTransform(Matrix4::Translation(centre));
+	rnode->SetBoundingRadius(radius);
+
+	PhysicsNode* pnode = NULL;
+	if (physics_enabled)
+	{
+		pnode = new PhysicsNode();
+		pnode->SetPosition(centre);
+		pnode->SetInverseMass(inverse_mass);
+		pnode->SetBoundingRadius(radius);
+		pnode->SetInverseInertia(pColshape->BuildInverseInertia(inverse_mass));
+
+		if (collidable)
+		{
+			pnode->SetCollisionShape(pColshape);
+			pColshape = NULL;
+		}
+	}
+	delete pColshape;
+
+	GameObject* obj = new GameObject(name, rnode, pnode);
+
+	if (dragable)
+	{
+		ScreenPicker::Instance()->RegisterNodeForMouseCallback(
+			dummy, //Dummy is the rendernode that actually contains the drawable mesh
+			std::bind(&DragableObjectCallback, obj, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4)
+		);
+	}
+
+	return obj;
+}
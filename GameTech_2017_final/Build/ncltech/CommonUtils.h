@@ -63,6 +63,20 @@ namespace CommonUtils
 		bool rest = false,
 		CommonMeshes::MeshType meshType = CommonMeshes::MeshType::DEFAULT_CUBE);
 
+	//Generates an object rendered with the given mesh, colliding as the convex hull around the mesh's vertices
+	// - The mesh isn't owned by the object and has to outlive it
+	// - The mesh's origin is placed at pos, the physics node itself sits at the hull's centre of mass
+	GameObject* BuildConvexHullObject(
+		const std::string& name,
+		const Vector3& pos,
+		Mesh* mesh,
+		const Vector3& scale = Vector3(1.0f, 1.0f, 1.0f),
+		bool physics_enabled = false,
+		float inverse_mass = 0.0f,			//requires physics_enabled = true
+		bool collidable = true,				//requires physics_enabled = true
+		bool dragable = true,
+		const Vector4& color = Vector4(1.0f, 1.0f, 1.0f, 1.0f));
+
 	inline static bool isInteger(const std::string& s) { return s.find_first_not_of("0123456789") == std::string::npos; }
 
 	//https://stackoverflow.com/questions/447206/c-isfloat-function
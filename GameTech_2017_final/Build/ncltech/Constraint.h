@@ -28,26 +28,37 @@ Description:
 
 #pragma once
 #include "PhysicsNode.h"
-#include <nclgl\Vector3.h>
+#include "SolverBodies.h"
+#include <nclgl/Vector3.h>
 
 class Constraint
 {
 public:
 	Constraint() {}
+	virtual ~Constraint() {}
 
 
 	// Apply Velocity Impulse to object(s) in order to satisfy given constraint
 	//  - Called by PhysicsEngine upon resolving constraints
-	virtual void ApplyImpulse() = 0;
+	//  - Works on the solver's copy of the velocities, looked up with PhysicsNode::GetBodyIndex
+	//  - Returns the change in relative velocity applied, the solver stops iterating once this gets small
+	virtual float ApplyImpulse(SolverBodies& bodies) = 0;
 	
 
 	// Optional: Pre-solver step will be triggered before any calls to ApplyImpulse
 	//			 and only ever be called once per physics timestep
 	//  - If you need to precompute any data/velocity forces prior to them changing
 	//    through this (or other constraints) then you can do it here.
+	//  - Body indices are valid from here until the end of the step
 	virtual void PreSolverStep(float dt) {}
 
 
 	// Visually Debug Constraint 
 	virtual void DebugDraw() const {}
+
+
+	// The two objects joined by the constraint, used to group objects into simulation islands
+	//  - Constraints that don't join two objects can leave these as NULL
+	virtual PhysicsNode* NodeA() const { return NULL; }
+	virtual PhysicsNode* NodeB() const { return NULL; }
 };
\ No newline at end of file
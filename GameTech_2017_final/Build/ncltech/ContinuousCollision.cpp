@@ -0,0 +1,242 @@
+#include "ContinuousCollision.h"
+
+bool ContinuousCollision::SweepSphere(
+	const Vector3& start,
+	const Vector3& motion,
+	float radius,
+	const PhysicsNode* other,
+	float& out_fraction,
+	Vector3& out_normal)
+{
+	const CollisionShape* shape = other->GetCollisionShape();
+	if (!shape)
+	{
+		return false;
+	}
+
+	//Vertices of the simplex are points on the grown shape, the closest point is measured from the ray's position x
+	Vector3 simplex[4];
+	unsigned int simplexSize = 0;
+
+	float lambda = 0.0f;
+	Vector3 x = start;
+	Vector3 normal;
+
+	//v points from the closest point found so far on the grown shape to x
+	Vector3 v = x - other->GetPosition();
+	if (Vector3::Dot(v, v) < 1e-12f)
+	{
+		v = -motion;
+	}
+
+	for (unsigned int i = 0; i < CCD_MAX_ITERATIONS; ++i)
+	{
+		const float vLengthSq = Vector3::Dot(v, v);
+		if (vLengthSq <= CCD_TOLERANCE * CCD_TOLERANCE)
+		{
+			//Reached the shape, unless the sphere was already touching it where it started
+			if (lambda <= 0.0f)
+			{
+				return false;
+			}
+
+			out_fraction = lambda;
+			out_normal = normal;
+			out_normal.Normalise();
+			return true;
+		}
+
+		//Furthest point on the grown shape towards x
+		const Vector3 p = shape->GetSupportPoint(v) + v * (radius / sqrtf(vLengthSq));
+		const Vector3 w = x - p;
+
+		const float vw = Vector3::Dot(v, w);
+		const bool advance = vw > 0.0f;
+		if (advance)
+		{
+			//The whole shape is behind the plane through p facing x, so the ray can move up to that plane
+			const float vr = Vector3::Dot(v, motion);
+			if (vr >= 0.0f)
+			{
+				return false;
+			}
+
+			lambda -= vw / vr;
+			if (lambda > 1.0f)
+			{
+				return false;
+			}
+
+			x = start + motion * lambda;
+			normal = v;
+		}
+
+		simplex[simplexSize++] = p;
+		const Vector3 closest = ClosestPointOnSimplex(x, simplex, simplexSize);
+		v = x - closest;
+
+		//If x is inside the simplex it is inside the grown shape. Otherwise, while the ray isn't moving GJK gets closer
+		// to the shape every iteration unless x is already touching it, so if it stops getting closer x is as close
+		// as floating point precision allows.
+		if (simplexSize == 4 || (!advance && Vector3::Dot(v, v) >= vLengthSq * 0.9999f))
+		{
+			v = Vector3(0.0f, 0.0f, 0.0f);
+		}
+	}
+
+	//Failed to converge, leave the pair to the narrowphase
+	return false;
+}
+
+Vector3 ContinuousCollision::ClosestPointOnSimplex(const Vector3& point, Vector3* simplex, unsigned int& size)
+{
+	switch (size)
+	{
+	case 1:
+		return simplex[0];
+
+	case 2:
+	{
+		const Vector3 a = simplex[0];
+		const Vector3 ab = simplex[1] - a;
+		const float lengthSq = Vector3::Dot(ab, ab);
+		const float t = (lengthSq > 1e-12f) ? Vector3::Dot(point - a, ab) / lengthSq : 0.0f;
+		if (t <= 0.0f)
+		{
+			size = 1;
+			return a;
+		}
+		if (t >= 1.0f)
+		{
+			simplex[0] = simplex[1];
+			size = 1;
+			return simplex[0];
+		}
+		return a + ab * t;
+	}
+
+	case 3:
+		return ClosestPointOnTriangle(point, simplex, size);
+
+	default:
+	{
+		//Check each face the point is in front of (or level with, for a flat tetrahedron), keeping the closest
+		const unsigned int faces[4][4] = { { 0, 1, 2, 3 }, { 0, 1, 3, 2 }, { 0, 2, 3, 1 }, { 1, 2, 3, 0 } };
+
+		Vector3 best = point;
+		Vector3 bestSimplex[3];
+		unsigned int bestSize = 4;
+		float bestDistSq = FLT_MAX;
+
+		for (unsigned int i = 0; i < 4; ++i)
+		{
+			const Vector3& a = simplex[faces[i][0]];
+			const Vector3 n = Vector3::Cross(simplex[faces[i][1]] - a, simplex[faces[i][2]] - a);
+			if (Vector3::Dot(point - a, n) * Vector3::Dot(simplex[faces[i][3]] - a, n) > 0.0f)
+			{
+				continue;
+			}
+
+			Vector3 face[3] = { a, simplex[faces[i][1]], simplex[faces[i][2]] };
+			unsigned int faceSize = 3;
+			const Vector3 closest = ClosestPointOnTriangle(point, face, faceSize);
+			const float distSq = Vector3::Dot(point - closest, point - closest);
+			if (distSq < bestDistSq)
+			{
+				bestDistSq = distSq;
+				best = closest;
+				bestSize = faceSize;
+				for (unsigned int j = 0; j < faceSize; ++j)
+				{
+					bestSimplex[j] = face[j];
+				}
+			}
+		}
+
+		//If the point isn't in front of any face it is inside the tetrahedron, which is left as it is
+		if (bestSize < 4)
+		{
+			for (unsigned int j = 0; j < bestSize; ++j)
+			{
+				simplex[j] = bestSimplex[j];
+			}
+			size = bestSize;
+		}
+		return best;
+	}
+	}
+}
+
+Vector3 ContinuousCollision::ClosestPointOnTriangle(const Vector3& point, Vector3* simplex, unsigned int& size)
+{
+	//Finds which vertex, edge or face region of the triangle the point is in (Real-Time Collision Detection, 5.1.5)
+	const Vector3 a = simplex[0];
+	const Vector3 b = simplex[1];
+	const Vector3 c = simplex[2];
+
+	const Vector3 ab = b - a;
+	const Vector3 ac = c - a;
+
+	const Vector3 ap = point - a;
+	const float d1 = Vector3::Dot(ab, ap);
+	const float d2 = Vector3::Dot(ac, ap);
+	if (d1 <= 0.0f && d2 <= 0.0f)
+	{
+		size = 1;
+		return a;
+	}
+
+	const Vector3 bp = point - b;
+	const float d3 = Vector3::Dot(ab, bp);
+	const float d4 = Vector3::Dot(ac, bp);
+	if (d3 >= 0.0f && d4 <= d3)
+	{
+		simplex[0] = b;
+		size = 1;
+		return b;
+	}
+
+	const float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+	{
+		size = 2;
+		return a + ab * (d1 / (d1 - d3));
+	}
+
+	const Vector3 cp = point - c;
+	const float d5 = Vector3::Dot(ab, cp);
+	const float d6 = Vector3::Dot(ac, cp);
+	if (d6 >= 0.0f && d5 <= d6)
+	{
+		simplex[0] = c;
+		size = 1;
+		return c;
+	}
+
+	const float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+	{
+		simplex[1] = c;
+		size = 2;
+		return a + ac * (d2 / (d2 - d6));
+	}
+
+	const float va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+	{
+		simplex[0] = b;
+		simplex[1] = c;
+		size = 2;
+		return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+	}
+
+	//A triangle with no area has no face region, the tests above will have found the closest edge or vertex
+	const float denom = va + vb + vc;
+	if (denom <= 1e-12f)
+	{
+		size = 1;
+		return a;
+	}
+
+	return a + ab * (vb / denom) + ac * (vc / denom);
+}
@@ -0,0 +1,53 @@
+/******************************************************************************
+Class: ContinuousCollision
+Implements:
+Author:
+	Pieran Marris <p.marris@newcastle.ac.uk> and YOU!
+Description:
+
+	Time of impact tests for fast moving objects (bullets, see PhysicsNode::SetBullet).
+
+	The narrowphase only checks where objects are at the end of each step, so anything
+	that moves further than its own size in a step can pass straight through a thin
+	object without ever being seen to overlap it. Bullets are instead swept through the
+	step as a sphere, and stopped at the first thing the sphere touches.
+
+	The sweep is a GJK ray cast (van den Bergen): a ray from the sphere's centre is cast
+	against the other shape grown by the sphere's radius, which is only ever explored
+	through its support function (CollisionShape::GetSupportPoint plus the radius along
+	the same direction), so it works for every collision shape.
+		- GJK finds the closest point on the grown shape to the ray's current position
+		- If the shape is entirely on the far side of a plane facing the ray, the ray
+		  can safely move forward until it reaches that plane
+		- Repeat until the ray reaches the shape, or leaves it behind
+
+*//////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "PhysicsNode.h"
+#include "CollisionShape.h"
+
+#define CCD_MAX_ITERATIONS 32		//GJK iterations before a sweep gives up and reports no impact
+#define CCD_TOLERANCE 0.001f		//A sweep has reached the shape once it is closer than this (m)
+
+class ContinuousCollision
+{
+public:
+	//Sweeps a sphere from start along motion against the other node's collision shape, where the node is now
+	// - Returns true if the sphere touches the shape before the end of the motion, along with the fraction of the
+	//   motion travelled first and the normal of the impact (pointing from the shape to the sphere)
+	// - A sphere that already overlaps the shape at the start isn't reported, that is left to the narrowphase
+	static bool SweepSphere(
+		const Vector3& start,
+		const Vector3& motion,
+		float radius,
+		const PhysicsNode* other,
+		float& out_fraction,
+		Vector3& out_normal);
+
+protected:
+	//Closest point on the simplex to the given point. The simplex is reduced to the vertices that
+	// closest point lies on, so a simplex of 4 is only left if the point is inside it.
+	static Vector3 ClosestPointOnSimplex(const Vector3& point, Vector3* simplex, unsigned int& size);
+
+	static Vector3 ClosestPointOnTriangle(const Vector3& point, Vector3* simplex, unsigned int& size);
+};
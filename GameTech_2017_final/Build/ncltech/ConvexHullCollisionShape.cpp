@@ -0,0 +1,649 @@
+#include "ConvexHullCollisionShape.h"
+#include "PhysicsNode.h"
+#include "GeometryUtils.h"
+#include <nclgl/Mesh.h>
+#include <nclgl/ChildMeshInterface.h>
+#include <nclgl/NCLDebug.h>
+#include <algorithm>
+#include <map>
+
+//Points within this fraction of the point cloud's size of a face are treated as lying on it
+#define QUICKHULL_EPSILON 0.00001f
+
+//Triangles whose normals are closer than this are candidates for merging into one polygon face
+#define QUICKHULL_MERGE_COS 0.99999f
+
+//Triangle of the hull while quickhull is running
+struct QuickHullFace
+{
+	int					v[3];		//Counter clockwise when looking at the outside of the hull
+	Vector3				normal;
+	float				distance;	//Plane distance along the normal
+	bool				alive;
+	std::vector<int>	outside;	//Points in front of the face that haven't been added to the hull yet
+};
+
+//Each directed edge of the hull is owned by one face, the face across it owns the same edge the other way round
+typedef std::map<std::pair<int, int>, int> QuickHullEdgeMap;
+
+static void AddQuickHullFace(std::vector<QuickHullFace>& faces, QuickHullEdgeMap& edge_faces, const std::vector<Vector3>& points, int a, int b, int c)
+{
+	QuickHullFace face;
+	face.v[0] = a;
+	face.v[1] = b;
+	face.v[2] = c;
+	face.normal = Vector3::Cross(points[b] - points[a], points[c] - points[a]);
+	face.normal.Normalise();
+	face.distance = Vector3::Dot(face.normal, points[a]);
+	face.alive = true;
+
+	for (int e = 0; e < 3; ++e)
+	{
+		edge_faces[std::make_pair(face.v[e], face.v[(e + 1) % 3])] = (int)faces.size();
+	}
+
+	faces.push_back(face);
+}
+
+//Gives the point to the face it is furthest in front of, if it is in front of any
+static void AssignOutsidePoint(std::vector<QuickHullFace>& faces, const std::vector<Vector3>& points, int idx, float epsilon)
+{
+	QuickHullFace* best_face = NULL;
+	float best_distance = epsilon;
+	for (QuickHullFace& face : faces)
+	{
+		if (!face.alive)
+			continue;
+
+		const float distance = Vector3::Dot(face.normal, points[idx]) - face.distance;
+		if (distance > best_distance)
+		{
+			best_distance = distance;
+			best_face = &face;
+		}
+	}
+
+	if (best_face)
+	{
+		best_face->outside.push_back(idx);
+	}
+}
+
+static void GatherMeshVertices(const Mesh* mesh, const Vector3& scale, std::vector<Vector3>& out_points)
+{
+	if (mesh->vertices)
+	{
+		for (GLuint i = 0; i < mesh->numVertices; ++i)
+		{
+			out_points.push_back(mesh->vertices[i] * scale);
+		}
+	}
+
+	//OBJ and MD5 meshes keep each extra part as a child mesh
+	const ChildMeshInterface* parentMesh = dynamic_cast<const ChildMeshInterface*>(mesh);
+	if (parentMesh)
+	{
+		for (const Mesh* child : parentMesh->GetChildren())
+		{
+			GatherMeshVertices(child, scale, out_points);
+		}
+	}
+}
+
+
+ConvexHullCollisionShape::ConvexHullCollisionShape(const Vector3* points, size_t numPoints, const Vector3& scale)
+	: boundingRadius(0.0f)
+	, centreOfMass(0.0f, 0.0f, 0.0f)
+	, unitInertia(Matrix3::Identity)
+	, lastMaxVertex(0)
+	, lastMinVertex(0)
+{
+	std::vector<Vector3> scaled_points(numPoints);
+	for (size_t i = 0; i < numPoints; ++i)
+	{
+		scaled_points[i] = points[i] * scale;
+	}
+
+	BuildHull(scaled_points);
+}
+
+ConvexHullCollisionShape::ConvexHullCollisionShape(const Mesh* mesh, const Vector3& scale)
+	: boundingRadius(0.0f)
+	, centreOfMass(0.0f, 0.0f, 0.0f)
+	, unitInertia(Matrix3::Identity)
+	, lastMaxVertex(0)
+	, lastMinVertex(0)
+{
+	std::vector<Vector3> points;
+	GatherMeshVertices(mesh, scale, points);
+
+	BuildHull(points);
+}
+
+ConvexHullCollisionShape::~ConvexHullCollisionShape()
+{
+
+}
+
+void ConvexHullCollisionShape::BuildHull(std::vector<Vector3>& points)
+{
+	hull.Clear();
+	memset(aabbVertices, 0, sizeof(aabbVertices));
+
+	if (points.size() < 4)
+	{
+		NCLERROR("Convex hull needs at least 4 points, only given %d", (int)points.size());
+		return;
+	}
+
+	//Scale the tolerance to the size of the point cloud
+	BoundingBox bounds;
+	for (const Vector3& p : points)
+	{
+		bounds.ExpandToFit(p);
+	}
+	const Vector3 size = bounds._max - bounds._min;
+	const float epsilon = QUICKHULL_EPSILON * (size.x + size.y + size.z);
+
+	//Work relative to the centre of the points, so a cloud away from the origin doesn't lose float precision
+	const Vector3 centre = (bounds._min + bounds._max) * 0.5f;
+	for (Vector3& p : points)
+	{
+		p = p - centre;
+	}
+
+
+	//<----- INITIAL TETRAHEDRON ----->
+	//The two points furthest apart out of the min/max points along each axis
+	int extremes[6] = { 0, 0, 0, 0, 0, 0 };
+	for (int i = 1; i < (int)points.size(); ++i)
+	{
+		const float* coords = &points[i].x;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			if (coords[axis] < (&points[extremes[axis * 2]].x)[axis])		extremes[axis * 2] = i;
+			if (coords[axis] > (&points[extremes[axis * 2 + 1]].x)[axis])	extremes[axis * 2 + 1] = i;
+		}
+	}
+
+	int i0 = 0, i1 = 0;
+	float best_distance = 0.0f;
+	for (int a = 0; a < 6; ++a)
+	{
+		for (int b = a + 1; b < 6; ++b)
+		{
+			const Vector3 ab = points[extremes[b]] - points[extremes[a]];
+			const float distSq = Vector3::Dot(ab, ab);
+			if (distSq > best_distance)
+			{
+				best_distance = distSq;
+				i0 = extremes[a];
+				i1 = extremes[b];
+			}
+		}
+	}
+
+	//The point furthest from the line between them
+	Vector3 line_dir = points[i1] - points[i0];
+	line_dir.Normalise();
+
+	int i2 = i0;
+	best_distance = 0.0f;
+	for (int i = 0; i < (int)points.size(); ++i)
+	{
+		const float distance = Vector3::Cross(points[i] - points[i0], line_dir).Length();
+		if (distance > best_distance)
+		{
+			best_distance = distance;
+			i2 = i;
+		}
+	}
+
+	//The point furthest from the plane through all three
+	Vector3 plane_normal = Vector3::Cross(points[i1] - points[i0], points[i2] - points[i0]);
+	plane_normal.Normalise();
+
+	int i3 = i0;
+	float best_plane_distance = 0.0f;
+	for (int i = 0; i < (int)points.size(); ++i)
+	{
+		const float distance = fabs(Vector3::Dot(points[i] - points[i0], plane_normal));
+		if (distance > best_plane_distance)
+		{
+			best_plane_distance = distance;
+			i3 = i;
+		}
+	}
+
+	if (best_distance <= epsilon || best_plane_distance <= epsilon)
+	{
+		NCLERROR("Convex hull points are all on one line or plane, no hull can be built");
+		return;
+	}
+
+	//Wind the first face so it faces away from the fourth point, the other three faces follow from its edges
+	if (Vector3::Dot(plane_normal, points[i3] - points[i0]) > 0.0f)
+	{
+		std::swap(i1, i2);
+	}
+
+	std::vector<QuickHullFace> faces;
+	QuickHullEdgeMap edge_faces;
+	AddQuickHullFace(faces, edge_faces, points, i0, i1, i2);
+	AddQuickHullFace(faces, edge_faces, points, i0, i3, i1);
+	AddQuickHullFace(faces, edge_faces, points, i1, i3, i2);
+	AddQuickHullFace(faces, edge_faces, points, i2, i3, i0);
+
+	for (int i = 0; i < (int)points.size(); ++i)
+	{
+		if (i != i0 && i != i1 && i != i2 && i != i3)
+		{
+			AssignOutsidePoint(faces, points, i, epsilon);
+		}
+	}
+
+
+	//<----- EXPAND THE HULL ----->
+	std::vector<std::pair<int, int>> horizon;
+	std::vector<int> orphans;
+	std::vector<int> open_faces;
+	while (true)
+	{
+		//Find a face that still has points in front of it
+		// - Orphaned points can be given to any face, not just the new ones, so every face has to be checked again
+		size_t f = 0;
+		while (f < faces.size() && (!faces[f].alive || faces[f].outside.empty()))
+		{
+			++f;
+		}
+
+		if (f == faces.size())
+			break;
+
+		//The point furthest in front of the face is definitely on the hull
+		int eye = faces[f].outside[0];
+		float eye_distance = -FLT_MAX;
+		for (int idx : faces[f].outside)
+		{
+			const float distance = Vector3::Dot(faces[f].normal, points[idx]);
+			if (distance > eye_distance)
+			{
+				eye_distance = distance;
+				eye = idx;
+			}
+		}
+
+		//Flood out from the face to every face the point can see, the edges where the flood stops form the horizon
+		// - Only following neighbours keeps the removed faces in one patch, so the horizon is always a single loop
+		horizon.clear();
+		orphans.clear();
+		open_faces.clear();
+		open_faces.push_back((int)f);
+		faces[f].alive = false;
+		while (!open_faces.empty())
+		{
+			QuickHullFace& face = faces[open_faces.back()];
+			open_faces.pop_back();
+
+			for (int e = 0; e < 3; ++e)
+			{
+				const int a = face.v[e];
+				const int b = face.v[(e + 1) % 3];
+
+				const int g = edge_faces[std::make_pair(b, a)];
+				if (!faces[g].alive)
+					continue;
+
+				if (Vector3::Dot(faces[g].normal, points[eye]) - faces[g].distance > 0.0f)
+				{
+					faces[g].alive = false;
+					open_faces.push_back(g);
+				}
+				else
+				{
+					horizon.push_back(std::make_pair(a, b));
+				}
+			}
+
+			orphans.insert(orphans.end(), face.outside.begin(), face.outside.end());
+			face.outside.clear();
+		}
+
+		//Join the horizon to the new point, keeping the winding of the faces that were removed
+		for (const std::pair<int, int>& edge : horizon)
+		{
+			AddQuickHullFace(faces, edge_faces, points, edge.first, edge.second, eye);
+		}
+
+		//Points the removed faces were holding either go to a new face or are now inside the hull
+		for (int idx : orphans)
+		{
+			if (idx != eye)
+			{
+				AssignOutsidePoint(faces, points, idx, epsilon);
+			}
+		}
+	}
+
+
+	//<----- MERGE COPLANAR FACES ----->
+	std::vector<int> hull_vertex(points.size(), -1);
+	std::vector<int> face_group(faces.size(), -1);
+	std::map<int, int> boundary;
+	std::vector<int> polygon;
+	for (size_t f = 0; f < faces.size(); ++f)
+	{
+		if (!faces[f].alive || face_group[f] != -1)
+			continue;
+
+		const Vector3 normal = faces[f].normal;
+		const float distance = faces[f].distance;
+
+		//Flood out from the triangle to its neighbours lying in the same plane
+		// - Edges between two triangles of the group are skipped, the rest form the polygon's outline (still counter clockwise)
+		boundary.clear();
+		open_faces.clear();
+		open_faces.push_back((int)f);
+		face_group[f] = (int)f;
+		while (!open_faces.empty())
+		{
+			const QuickHullFace& face = faces[open_faces.back()];
+			open_faces.pop_back();
+
+			for (int e = 0; e < 3; ++e)
+			{
+				const int a = face.v[e];
+				const int b = face.v[(e + 1) % 3];
+
+				const int g = edge_faces[std::make_pair(b, a)];
+				if (face_group[g] == (int)f)
+					continue;
+
+				bool coplanar = face_group[g] == -1 && Vector3::Dot(faces[g].normal, normal) > QUICKHULL_MERGE_COS;
+				for (int i = 0; coplanar && i < 3; ++i)
+				{
+					coplanar = fabs(Vector3::Dot(normal, points[faces[g].v[i]]) - distance) <= epsilon;
+				}
+
+				if (coplanar)
+				{
+					face_group[g] = (int)f;
+					open_faces.push_back(g);
+				}
+				else
+				{
+					boundary[a] = b;
+				}
+			}
+		}
+
+		//Walk around the outline, adding each vertex to the hull the first time it is used
+		polygon.clear();
+		int vert = boundary.begin()->first;
+		do
+		{
+			if (hull_vertex[vert] == -1)
+			{
+				hull_vertex[vert] = hull.AddVertex(points[vert] + centre);
+			}
+			polygon.push_back(hull_vertex[vert]);
+			vert = boundary[vert];
+		} while (vert != boundary.begin()->first && polygon.size() <= boundary.size());
+
+		//Newell's method averages the normal over the whole polygon, rather than just the triangle it grew from
+		Vector3 polygon_normal = Vector3(0.0f, 0.0f, 0.0f);
+		for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++)
+		{
+			const Vector3 a = hull.GetVertex(polygon[j])._pos - centre;
+			const Vector3 b = hull.GetVertex(polygon[i])._pos - centre;
+			polygon_normal = polygon_normal + Vector3::Cross(a, b);
+		}
+		polygon_normal.Normalise();
+
+		hull.AddFace(polygon_normal, polygon);
+	}
+
+	BuildMassProperties();
+
+	//The node rotates about its position, so move the hull to put its centre of mass there
+	boundingRadius = 0.0f;
+	for (HullVertex& vertex : hull.m_vVertices)
+	{
+		vertex._pos = vertex._pos - centreOfMass;
+
+		const float radius = vertex._pos.Length();
+		if (radius > boundingRadius)
+		{
+			boundingRadius = radius;
+		}
+	}
+}
+
+void ConvexHullCollisionShape::BuildMassProperties()
+{
+	//Split the hull into tetrahedrons between each face triangle and a point inside the hull, and sum their
+	// volume, centre of mass and covariance (the inertia integrals before being turned into an inertia tensor)
+	Vector3 reference = Vector3(0.0f, 0.0f, 0.0f);
+	for (size_t i = 0; i < hull.GetNumVertices(); ++i)
+	{
+		reference = reference + hull.GetVertex(i)._pos;
+	}
+	reference = reference / (float)hull.GetNumVertices();
+
+	float volume = 0.0f;
+	Vector3 weighted_centre = Vector3(0.0f, 0.0f, 0.0f);
+	Matrix3 covariance = Matrix3::ZeroMatrix;
+	for (size_t i = 0; i < hull.GetNumFaces(); ++i)
+	{
+		const HullFace& face = hull.GetFace(i);
+		const Vector3 a = hull.GetVertex(face._vert_ids[0])._pos - reference;
+		for (size_t j = 2; j < face._vert_ids.size(); ++j)
+		{
+			const Vector3 b = hull.GetVertex(face._vert_ids[j - 1])._pos - reference;
+			const Vector3 c = hull.GetVertex(face._vert_ids[j])._pos - reference;
+
+			const float det = Vector3::Dot(a, Vector3::Cross(b, c));
+			const float tet_volume = det / 6.0f;
+			const Vector3 sum = a + b + c;
+
+			//Covariance of the tetrahedron (0, a, b, c) is det/120 * (aa' + bb' + cc' + (a+b+c)(a+b+c)')
+			volume += tet_volume;
+			weighted_centre = weighted_centre + sum * (tet_volume * 0.25f);
+			covariance += (Matrix3::OuterProduct(a, a) + Matrix3::OuterProduct(b, b) + Matrix3::OuterProduct(c, c)
+				+ Matrix3::OuterProduct(sum, sum)) * (det / 120.0f);
+		}
+	}
+
+	if (volume <= 0.0f)
+	{
+		NCLERROR("Convex hull has no volume, unable to compute its inertia");
+		return;
+	}
+
+	//Move the covariance from the reference point to the centre of mass
+	const Vector3 centre = weighted_centre / volume;
+	covariance -= Matrix3::OuterProduct(centre, centre) * volume;
+
+	centreOfMass = reference + centre;
+	unitInertia = (Matrix3::Identity * covariance.Trace() - covariance) * (1.0f / volume);
+}
+
+Matrix3 ConvexHullCollisionShape::BuildInverseInertia(float invMass) const
+{
+	return Matrix3::Inverse(unitInertia) * invMass;
+}
+
+Vector3 ConvexHullCollisionShape::LocalToWorldPoint(const Vector3& point) const
+{
+	return Parent()->GetPosition() + Parent()->GetWorldSpaceRotation() * point;
+}
+
+int ConvexHullCollisionShape::FindFurthestVertex(const Vector3& local_axis, std::atomic<int>& cached_vert) const
+{
+	const int vert = hull.GetFurthestVertexInAxis(local_axis, cached_vert.load(std::memory_order_relaxed));
+	cached_vert.store(vert, std::memory_order_relaxed);
+	return vert;
+}
+
+BoundingBox ConvexHullCollisionShape::BuildWorldSpaceAABB() const
+{
+	if (hull.GetNumVertices() == 0)
+	{
+		const Vector3 pos = Parent()->GetPosition();
+		return BoundingBox(pos, pos);
+	}
+
+	//Climb to the furthest vertex along each world axis, starting from the ones found last time
+	// - The rows of the node's rotation are the world axes in local space
+	const Matrix3& rotation = Parent()->GetWorldSpaceRotation();
+	float mins[3], maxs[3];
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		const Vector3 local_axis = rotation.GetRow(axis);
+
+		aabbVertices[axis * 2] = hull.GetFurthestVertexInAxis(-local_axis, aabbVertices[axis * 2]);
+		aabbVertices[axis * 2 + 1] = hull.GetFurthestVertexInAxis(local_axis, aabbVertices[axis * 2 + 1]);
+
+		mins[axis] = Vector3::Dot(local_axis, hull.GetVertex(aabbVertices[axis * 2])._pos);
+		maxs[axis] = Vector3::Dot(local_axis, hull.GetVertex(aabbVertices[axis * 2 + 1])._pos);
+	}
+
+	const Vector3 pos = Parent()->GetPosition();
+	return BoundingBox(
+		pos + Vector3(mins[0], mins[1], mins[2]),
+		pos + Vector3(maxs[0], maxs[1], maxs[2]));
+}
+
+void ConvexHullCollisionShape::GetCollisionAxes(
+	const PhysicsNode* otherObject,
+	CollisionAxes& out_axes) const
+{
+	const Matrix3& objOrientation = Parent()->GetWorldSpaceRotation();
+	for (size_t i = 0; i < hull.GetNumFaces(); ++i)
+	{
+		out_axes.Add(objOrientation * hull.GetFace(i)._normal);
+	}
+}
+
+Vector3 ConvexHullCollisionShape::GetClosestPoint(const Vector3& point) const
+{
+	//Iterate over each edge and get the closest point on any edge to point p.
+	const Vector3 local_point = Parent()->WorldToLocalPoint(point);
+
+	float out_distSq = FLT_MAX;
+	Vector3 out_point = local_point;
+	for (size_t i = 0; i < hull.GetNumEdges(); ++i)
+	{
+		const HullEdge& e = hull.GetEdge(i);
+		Vector3 start = hull.GetVertex(e._vStart)._pos;
+		Vector3 end = hull.GetVertex(e._vEnd)._pos;
+
+		Vector3 ep = GeometryUtils::GetClosestPoint(local_point, Edge(start, end));
+
+		float distSq = Vector3::Dot(ep - local_point, ep - local_point);
+		if (distSq < out_distSq)
+		{
+			out_distSq = distSq;
+			out_point = ep;
+		}
+	}
+
+	return LocalToWorldPoint(out_point);
+}
+
+Vector3 ConvexHullCollisionShape::GetSupportPoint(const Vector3& dir) const
+{
+	if (hull.GetNumVertices() == 0)
+	{
+		return Parent()->GetPosition();
+	}
+
+	const Vector3 local_dir = Parent()->WorldToLocalDirection(dir);
+	const int vert = FindFurthestVertex(local_dir, lastMaxVertex);
+	return LocalToWorldPoint(hull.GetVertex(vert)._pos);
+}
+
+void ConvexHullCollisionShape::GetMinMaxVertexOnAxis(
+	const Vector3& axis,
+	Vector3& out_min,
+	Vector3& out_max) const
+{
+	if (hull.GetNumVertices() == 0)
+	{
+		out_min = out_max = Parent()->GetPosition();
+		return;
+	}
+
+	const Vector3 local_axis = Parent()->WorldToLocalDirection(axis);
+	const int vMin = FindFurthestVertex(-local_axis, lastMinVertex);
+	const int vMax = FindFurthestVertex(local_axis, lastMaxVertex);
+
+	out_min = LocalToWorldPoint(hull.GetVertex(vMin)._pos);
+	out_max = LocalToWorldPoint(hull.GetVertex(vMax)._pos);
+}
+
+void ConvexHullCollisionShape::GetIncidentReferencePolygon(
+	const Vector3& axis,
+	ArenaList<Vector3>& out_face,
+	Vector3& out_normal,
+	ArenaVector<Plane>& out_adjacent_planes) const
+{
+	if (hull.GetNumFaces() == 0)
+		return;
+
+	const Matrix3& normalMatrix = Parent()->GetWorldSpaceRotation();
+	const Vector3 local_axis = Parent()->WorldToLocalDirection(axis);
+
+	//Get the furthest vertex along axis - this will be part of the furthest face
+	const HullVertex& vert = hull.GetVertex(FindFurthestVertex(local_axis, lastMaxVertex));
+
+	//The face containing that vertex whose normal is closest to parallel with the collision axis
+	const HullFace* best_face = 0;
+	float best_correlation = -FLT_MAX;
+	for (int faceIdx : vert._enclosing_faces)
+	{
+		const HullFace* face = &hull.GetFace(faceIdx);
+		float temp_correlation = Vector3::Dot(local_axis, face->_normal);
+		if (temp_correlation > best_correlation)
+		{
+			best_correlation = temp_correlation;
+			best_face = face;
+		}
+	}
+
+	// Output face normal
+	out_normal = (normalMatrix * best_face->_normal).Normalise();
+
+	// Output face vertices (transformed back into world-space)
+	for (int vertIdx : best_face->_vert_ids)
+	{
+		out_face.push_back(LocalToWorldPoint(hull.GetVertex(vertIdx)._pos));
+	}
+
+	// Clip planes around each face sharing an edge with the reference face, same as CuboidCollisionShape
+	for (int edgeIdx : best_face->_edge_ids)
+	{
+		const HullEdge& edge = hull.GetEdge(edgeIdx);
+		const Vector3 wsPointOnPlane = LocalToWorldPoint(hull.GetVertex(edge._vStart)._pos);
+
+		for (int adjFaceIdx : edge._enclosing_faces)
+		{
+			if (adjFaceIdx != best_face->_idx)
+			{
+				const HullFace& adjFace = hull.GetFace(adjFaceIdx);
+
+				Vector3 planeNrml = -(normalMatrix * adjFace._normal);
+				planeNrml.Normalise();
+				float planeDist = -Vector3::Dot(planeNrml, wsPointOnPlane);
+
+				out_adjacent_planes.push_back(Plane(planeNrml, planeDist));
+			}
+		}
+	}
+}
+
+void ConvexHullCollisionShape::DebugDraw() const
+{
+	// Draw the hull at the position of our PhysicsNode
+	hull.DebugDraw(Parent()->GetWorldSpaceTransform());
+}
@@ -0,0 +1,126 @@
+/******************************************************************************
+Class: ConvexHullCollisionShape
+Implements: CollisionShape
+Author:
+	Pieran Marris      <p.marris@newcastle.ac.uk> and YOU!
+Description:
+
+	Extends CollisionShape to represent the convex hull of an arbitrary set of points,
+	so props can collide with a shape close to their render mesh rather than a sphere
+	or cuboid around it.
+
+	The hull is built once when the shape is created, using quickhull over the given
+	points (or the vertices of a Mesh and any of its child meshes):
+		1: Start from a tetrahedron between four extreme points
+		2: Give every remaining point to a face it lies in front of
+		3: Take the point furthest in front of any face, remove every face it can see
+		   and join the horizon around the hole to the point with new faces
+		4: Repeat until no point is in front of any face
+	Neighbouring triangles that end up in the same plane are then merged into single
+	polygon faces, and stored in a Hull so the faces, edges and their adjacency can be
+	used for clipping the same way as CuboidCollisionShape. The hull is then moved so
+	its centre of mass is at the shape's origin, which is what the node rotates about
+	(see GetCentreOfMass).
+
+	Support and min/max vertex queries hill climb over the hull's edges rather than
+	testing every vertex (see Hull::GetFurthestVertexInAxis), starting from the vertex
+	found by the previous query of the shape. Objects don't rotate far between queries,
+	so this normally only visits a few vertices however detailed the hull is.
+
+	Hulls can have far more face normals and edges than CollisionDetectionSAT has room
+	for, so any pair involving a convex hull is always collided with CollisionDetectionGJK.
+
+*//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "CollisionShape.h"
+#include "Hull.h"
+#include <atomic>
+
+class Mesh;
+
+class ConvexHullCollisionShape : public CollisionShape
+{
+public:
+	//Builds the hull around the given points (in the shape's local space), each multiplied by scale first
+	ConvexHullCollisionShape(const Vector3* points, size_t numPoints, const Vector3& scale = Vector3(1.0f, 1.0f, 1.0f));
+
+	//Builds the hull around every vertex of the mesh and any child meshes (e.g. each part of an OBJMesh)
+	// - Pass the same scale as the mesh is rendered with
+	ConvexHullCollisionShape(const Mesh* mesh, const Vector3& scale = Vector3(1.0f, 1.0f, 1.0f));
+	virtual ~ConvexHullCollisionShape();
+
+	virtual CollisionShapeType GetType() const override { return COLLISION_SHAPE_CONVEXHULL; }
+
+	const Hull& GetHull() const { return hull; }
+
+	// Distance of the furthest hull vertex from the shape's origin
+	float GetBoundingRadius() const { return boundingRadius; }
+
+	// Where the hull's centre of mass was amongst the points it was built from
+	// - The hull is moved so its centre of mass is at the shape's origin, so a point p given to the
+	//   constructor ends up at p - GetCentreOfMass(). Anything drawn with the source mesh needs moving by the same.
+	const Vector3& GetCentreOfMass() const { return centreOfMass; }
+
+	// Debug Collision Shape
+	virtual void DebugDraw() const override;
+
+
+	// Build Inertia Matrix for rotational mass
+	// - Assumes a solid hull of uniform density, about the hull's centre of mass
+	virtual Matrix3 BuildInverseInertia(float invMass) const override;
+
+	// Build world space AABB for the broadphase
+	virtual BoundingBox BuildWorldSpaceAABB() const override;
+
+
+	// Generic Collision Detection Routines
+	//  - Only as many face normals as SAT has room for are returned, see above
+	virtual void GetCollisionAxes(
+		const PhysicsNode* otherObject,
+		CollisionAxes& out_axes) const override;
+
+	virtual Vector3 GetClosestPoint(const Vector3& point) const override;
+
+	virtual Vector3 GetSupportPoint(const Vector3& dir) const override;
+
+	virtual void GetMinMaxVertexOnAxis(
+		const Vector3& axis,
+		Vector3& out_min,
+		Vector3& out_max) const override;
+
+	virtual void GetIncidentReferencePolygon(
+		const Vector3& axis,
+		ArenaList<Vector3>& out_face,
+		Vector3& out_normal,
+		ArenaVector<Plane>& out_adjacent_planes) const override;
+
+protected:
+	//Runs quickhull over the points and fills in the hull, centre of mass and inertia
+	// - The points are moved to be around their centre while the hull is built
+	void BuildHull(std::vector<Vector3>& points);
+
+	//Computes the volume, centre of mass and inertia of the finished hull
+	void BuildMassProperties();
+
+	//Furthest hull vertex along a local space axis, starting the climb from (and then updating) the given cached vertex
+	int FindFurthestVertex(const Vector3& local_axis, std::atomic<int>& cached_vert) const;
+
+	Vector3 LocalToWorldPoint(const Vector3& point) const;
+
+protected:
+	Hull				hull;
+	float				boundingRadius;
+	Vector3				centreOfMass;		//In the space of the points the hull was built from, see GetCentreOfMass
+	Matrix3				unitInertia;		//Inertia about the centre of mass for a mass of 1
+
+	//Vertices found by the last support queries in each direction, the next query starts climbing from here
+	// - Queries can come from several narrowphase threads at once, any of them leaving its result here is fine
+	mutable std::atomic<int>	lastMaxVertex;
+	mutable std::atomic<int>	lastMinVertex;
+
+	//Furthest vertex along each world axis (+x, -x, +y, -y, +z, -z) when the AABB was last built
+	// - Only used by BuildWorldSpaceAABB, which is only ever called for one node by one thread
+	mutable int					aabbVertices[6];
+};
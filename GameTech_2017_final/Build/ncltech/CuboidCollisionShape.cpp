@@ -44,14 +44,28 @@ Matrix3 CuboidCollisionShape::BuildInverseInertia(float invMass) const
 	return inertia;
 }
 
+BoundingBox CuboidCollisionShape::BuildWorldSpaceAABB() const
+{
+	//Project the rotated half dimensions onto each world axis
+	// - extent.x = |R00|*hx + |R01|*hy + |R02|*hz etc, where R is the rotation part of the world transform
+	const Matrix4& transform = Parent()->GetWorldSpaceTransform();
+	Vector3 extents;
+	extents.x = fabs(transform[0]) * halfDims.x + fabs(transform[4]) * halfDims.y + fabs(transform[8]) * halfDims.z;
+	extents.y = fabs(transform[1]) * halfDims.x + fabs(transform[5]) * halfDims.y + fabs(transform[9]) * halfDims.z;
+	extents.z = fabs(transform[2]) * halfDims.x + fabs(transform[6]) * halfDims.y + fabs(transform[10]) * halfDims.z;
+
+	const Vector3 pos = transform.GetPositionVector();
+	return BoundingBox(pos - extents, pos + extents);
+}
+
 void CuboidCollisionShape::GetCollisionAxes(
 	const PhysicsNode* otherObject,
-	std::vector<Vector3>& out_axes) const
+	CollisionAxes& out_axes) const
 {
-	Matrix3 objOrientation = Parent()->GetOrientation().ToMatrix3();
-	out_axes.push_back(objOrientation * Vector3(1.0f, 0.0f, 0.0f)); //X - Axis
-	out_axes.push_back(objOrientation * Vector3(0.0f, 1.0f, 0.0f)); //Y - Axis
-	out_axes.push_back(objOrientation * Vector3(0.0f, 0.0f, 1.0f)); //Z - Axis
+	const Matrix3& objOrientation = Parent()->GetWorldSpaceRotation();
+	out_axes.Add(objOrientation * Vector3(1.0f, 0.0f, 0.0f)); //X - Axis
+	out_axes.Add(objOrientation * Vector3(0.0f, 1.0f, 0.0f)); //Y - Axis
+	out_axes.Add(objOrientation * Vector3(0.0f, 0.0f, 1.0f)); //Z - Axis
 }
 
 Vector3 CuboidCollisionShape::GetClosestPoint(const Vector3& point) const
@@ -61,9 +75,9 @@ Vector3 CuboidCollisionShape::GetClosestPoint(const Vector3& point) const
 	// Build World Transform
 	Matrix4 wsTransform = Parent()->GetWorldSpaceTransform() * Matrix4::Scale(halfDims);
 
-	// Convert world space axis into model space (Axis Aligned Cuboid)
-	Matrix4 invWsTransform = Matrix4::Inverse(wsTransform);
-	Vector3 local_point = invWsTransform * point;
+	// Convert world space point into model space (Axis Aligned Cuboid)
+	// - Uses the node's cached inverse rotation and then undoes the scale, rather than inverting wsTransform
+	Vector3 local_point = Parent()->WorldToLocalPoint(point) / halfDims;
 
 	float out_distSq = FLT_MAX;
 	Vector3 out_point;
@@ -86,6 +100,18 @@ Vector3 CuboidCollisionShape::GetClosestPoint(const Vector3& point) const
 	return wsTransform * out_point;
 }
 
+Vector3 CuboidCollisionShape::GetSupportPoint(const Vector3& dir) const
+{
+	//The furthest corner along the direction is the one with the same signs as the local direction
+	const Vector3 local_dir = Parent()->WorldToLocalDirection(dir);
+	const Vector3 corner = Vector3(
+		local_dir.x < 0.0f ? -halfDims.x : halfDims.x,
+		local_dir.y < 0.0f ? -halfDims.y : halfDims.y,
+		local_dir.z < 0.0f ? -halfDims.z : halfDims.z);
+
+	return Parent()->GetPosition() + Parent()->GetWorldSpaceRotation() * corner;
+}
+
 void CuboidCollisionShape::GetMinMaxVertexOnAxis(
 	const Vector3& axis,
 	Vector3& out_min,
@@ -95,8 +121,7 @@ void CuboidCollisionShape::GetMinMaxVertexOnAxis(
 	Matrix4 wsTransform = Parent()->GetWorldSpaceTransform() * Matrix4::Scale(halfDims);
 
 	// Convert world space axis into model space (Axis Aligned Cuboid)
-	Matrix3 invNormalMatrix = Matrix3::Inverse(Matrix3(wsTransform));
-	Vector3 local_axis = invNormalMatrix * axis;
+	Vector3 local_axis = Parent()->WorldToLocalDirection(axis) / halfDims;
 	local_axis.Normalise();
 
 	// Get closest and furthest vertex id's
@@ -112,19 +137,19 @@ void CuboidCollisionShape::GetMinMaxVertexOnAxis(
 
 void CuboidCollisionShape::GetIncidentReferencePolygon(
 	const Vector3& axis,
-	std::list<Vector3>& out_face,
+	ArenaList<Vector3>& out_face,
 	Vector3& out_normal,
-	std::vector<Plane>& out_adjacent_planes) const
+	ArenaVector<Plane>& out_adjacent_planes) const
 {
 	//Get the world-space transform
 	Matrix4 wsTransform = Parent()->GetWorldSpaceTransform() * Matrix4::Scale(halfDims);
 
-	//Get normal and inverse-normal matrices to transfom the collision axis to and from modelspace
-	Matrix3 invNormalMatrix = Matrix3::Inverse(Matrix3(wsTransform));
-	Matrix3 normalMatrix = Matrix3::Inverse(invNormalMatrix);
-
+	//Transform the collision axis into modelspace
+	// - The hull's face normals are axis aligned, so the scale doesn't change their direction and they only
+	//   need rotating back into world space
+	const Matrix3& normalMatrix = Parent()->GetWorldSpaceRotation();
 
-	Vector3 local_axis = invNormalMatrix * axis;
+	Vector3 local_axis = Parent()->WorldToLocalDirection(axis) / halfDims;
 
 
 	//Get the furthest vertex along axis - this will be part of the furthest face
@@ -18,7 +18,7 @@ Description:
 
 #include "Constraint.h"
 #include "PhysicsEngine.h"
-#include <nclgl\NCLDebug.h>
+#include <nclgl/NCLDebug.h>
 
 class DistanceConstraint : public Constraint
 {
@@ -45,15 +45,18 @@ public:
 		relPosB = Matrix3::Transpose(pnodeB->GetOrientation().ToMatrix3()) * r2;
 	}
 
-	//Solves the constraint and applies a velocity impulse to the two
-	// objects in order to satisfy the constraint.
-	virtual void ApplyImpulse() override
+	//Computes the constraint's direction, mass and baumgarte term once per step
+	// - The objects only move after the solver has finished, so these don't change while it iterates
+	virtual void PreSolverStep(float dt) override
 	{
+		bodyA = pnodeA->GetBodyIndex();
+		bodyB = pnodeB->GetBodyIndex();
+
 		//Compute current constraint vars based on object A/B's
 		//position/rotation
 
-		Vector3 r1 = pnodeA->GetOrientation().ToMatrix3() * relPosA;
-		Vector3 r2 = pnodeB->GetOrientation().ToMatrix3() * relPosB;
+		r1 = pnodeA->GetOrientation().ToMatrix3() * relPosA;
+		r2 = pnodeB->GetOrientation().ToMatrix3() * relPosB;
 
 		//Get the global contact points in world space
 
@@ -63,21 +66,10 @@ public:
 		//Get the vector between the two contact points
 
 		Vector3 ab = globalOnB - globalOnA;
-		Vector3 abn = ab;
+		abn = ab;
 
 		abn.Normalise();
 
-		//Compute the velocity of objects A and B at the point of contact
-
-		Vector3 v0 = pnodeA->GetLinearVelocity()
-			+ Vector3::Cross(pnodeA->GetAngularVelocity(), r1);
-
-		Vector3 v1 = pnodeB->GetLinearVelocity()
-			+ Vector3::Cross(pnodeB->GetAngularVelocity(), r2);
-
-		//Relative velocity in constraint direction
-		float abnVel = Vector3::Dot(v0 - v1, abn);
-
 		//Compute the 'mass' of the constraint
 		//e.g. How difficult it is to move the two objects in
 		//the direction of the constraint
@@ -92,35 +84,47 @@ public:
 				* Vector3::Cross(r2, abn), r2));
 
 
-		float constraintMass = invConstraintMassLin + invConstraintMassRot;
+		constraintMass = invConstraintMassLin + invConstraintMassRot;
 
-		if (constraintMass > 0.0f)
-		{
-			//Baumgarte Offset (Adds energy to the system to counter
-			//slight solving errors that accumulate over time - known
-			//as 'constraint drift')
+		//Baumgarte Offset (Adds energy to the system to counter
+		//slight solving errors that accumulate over time - known
+		//as 'constraint drift')
+
+		//Experiment by commenting this out and see how it
+		//affects the constraints over time and when you manually
+		//move the objects apart.
+
+		//The key is to find a nice value that is small enough
+		//not to cause objects to explode but also enough to make
+		//sure all constraints /will/ be satisfied. This value
+		//(0.1) will change based on your physics objects,
+		//timestep etc., and also how many constraints you are
+		//chaining together.
+
+		b = 0.0f;
 
-			//Experiment by commenting this out and see how it
-			//affects the constraints over time and when you manually
-			//move the objects apart.
+		//-Optional-
+		float distance_offset = ab.Length() - targetLength;
+		float baumgarte_scalar = 0.1f;
+		b = -(baumgarte_scalar / dt) * distance_offset;
 
-			//The key is to find a nice value that is small enough
-			//not to cause objects to explode but also enough to make
-			//sure all constraints /will/ be satisfied. This value
-			//(0.1) will change based on your physics objects,
-			//timestep etc., and also how many constraints you are
-			//chaining together.
+		//-Eof Optional-
+	}
+
+	//Solves the constraint and applies a velocity impulse to the two
+	// objects in order to satisfy the constraint.
+	virtual float ApplyImpulse(SolverBodies& bodies) override
+	{
+		if (constraintMass > 0.0f)
+		{
+			//Compute the velocity of objects A and B at the point of contact
 
-			float b = 0.0f;
+			Vector3 v0 = bodies.GetVelocityAt(bodyA, r1);
 
-			//-Optional-
-			float distance_offset = ab.Length() - targetLength;
-			float baumgarte_scalar = 0.1f;
-			b = -(baumgarte_scalar
-				/ PhysicsEngine::Instance()->GetDeltaTime())
-				* distance_offset;
+			Vector3 v1 = bodies.GetVelocityAt(bodyB, r2);
 
-			//-Eof Optional-
+			//Relative velocity in constraint direction
+			float abnVel = Vector3::Dot(v0 - v1, abn);
 
 			//Compute velocity impulse (jn)
 			//In order to satisfy the distance constraints we need
@@ -134,24 +138,21 @@ public:
 
 			float jn = -(abnVel + b) / constraintMass;
 
-			//Apply linear velocity impulse
-
-			pnodeA->SetLinearVelocity(pnodeA->GetLinearVelocity()
-				+ abn * (pnodeA->GetInverseMass() * jn));
-
-			pnodeB->SetLinearVelocity(pnodeB->GetLinearVelocity()
-				- abn * (pnodeB->GetInverseMass() * jn));
+			//Apply linear and rotational velocity impulse
 
-			//Apply rotational velocity impulse
+			bodies.ApplyImpulse(bodyA, abn * jn, r1);
 
-			pnodeA->SetAngularVelocity(pnodeA->GetAngularVelocity()
-				+ pnodeA->GetInverseInertia() * Vector3::Cross(r1, abn * jn));
+			bodies.ApplyImpulse(bodyB, -abn * jn, r2);
 
-			pnodeB->SetAngularVelocity(pnodeB->GetAngularVelocity()
-				- pnodeB->GetInverseInertia() * Vector3::Cross(r2, abn * jn));
+			return fabs(jn * constraintMass);
 		}
+
+		return 0.0f;
 	}
 
+	virtual PhysicsNode* NodeA() const { return pnodeA; }
+	virtual PhysicsNode* NodeB() const { return pnodeB; }
+
 	//Draw the constraint visually to the screen for debugging
 	virtual void DebugDraw() const
 	{
@@ -170,4 +171,11 @@ protected:
 
 	Vector3 relPosA;
 	Vector3 relPosB;
+
+	//Computed in PreSolverStep
+	unsigned int bodyA, bodyB;
+	Vector3 r1, r2;
+	Vector3 abn;
+	float   constraintMass;
+	float   b;
 };
\ No newline at end of file
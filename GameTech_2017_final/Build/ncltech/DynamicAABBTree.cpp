@@ -0,0 +1,518 @@
+#include "DynamicAABBTree.h"
+#include <nclgl/NCLDebug.h>
+
+//Smallest AABB enclosing both a and b
+static inline BoundingBox Union(const BoundingBox& a, const BoundingBox& b)
+{
+	BoundingBox bounds = a;
+	bounds.ExpandToFit(b);
+	return bounds;
+}
+
+DynamicAABBTree::DynamicAABBTree()
+{
+}
+
+DynamicAABBTree::DynamicAABBTree(std::vector<PhysicsNode*>& pNodes)
+{
+	for (PhysicsNode* pNode : pNodes)
+	{
+		InsertObject(pNode);
+	}
+}
+
+DynamicAABBTree::~DynamicAABBTree()
+{
+	Clear();
+}
+
+void DynamicAABBTree::InsertObject(PhysicsNode* pNode)
+{
+	//Already in the tree
+	if (m_leaves.find(pNode) != m_leaves.end())
+	{
+		return;
+	}
+
+	int leaf = AllocateNode();
+	BoundingBox bounds = pNode->GetWorldSpaceAABB();
+	m_nodes[leaf].pNode = pNode;
+	m_nodes[leaf].bounds = BoundingBox(
+		bounds._min - Vector3(AABB_TREE_MARGIN, AABB_TREE_MARGIN, AABB_TREE_MARGIN),
+		bounds._max + Vector3(AABB_TREE_MARGIN, AABB_TREE_MARGIN, AABB_TREE_MARGIN));
+
+	if ((int)m_tightBounds.size() <= leaf)
+	{
+		m_tightBounds.resize(m_nodes.size());
+	}
+	m_tightBounds[leaf] = bounds;
+
+	m_leaves[pNode] = leaf;
+	InsertLeaf(leaf);
+}
+
+void DynamicAABBTree::RemoveObject(PhysicsNode* pNode)
+{
+	auto found = m_leaves.find(pNode);
+	if (found != m_leaves.end())
+	{
+		RemoveLeaf(found->second);
+		FreeNode(found->second);
+		m_leaves.erase(found);
+	}
+}
+
+void DynamicAABBTree::Clear()
+{
+	m_nodes.clear();
+	m_tightBounds.clear();
+	m_leaves.clear();
+	m_root = AABB_TREE_NULL;
+	m_freeList = AABB_TREE_NULL;
+}
+
+void DynamicAABBTree::UpdateObjects()
+{
+	m_numReinserted = 0;
+	m_tightBounds.resize(m_nodes.size());
+
+	//Reinserting can add nodes to the end of the array, but they will never be leaves
+	const int numNodes = (int)m_nodes.size();
+	for (int i = 0; i < numNodes; ++i)
+	{
+		if (m_nodes[i].height != 0)
+		{
+			continue;
+		}
+
+		BoundingBox bounds = m_nodes[i].pNode->GetWorldSpaceAABB();
+		m_tightBounds[i] = bounds;
+
+		//Only nodes that have moved outside of their fat AABB need reinserting
+		if (!m_nodes[i].bounds.Contains(bounds))
+		{
+			RemoveLeaf(i);
+			m_nodes[i].bounds = BoundingBox(
+				bounds._min - Vector3(AABB_TREE_MARGIN, AABB_TREE_MARGIN, AABB_TREE_MARGIN),
+				bounds._max + Vector3(AABB_TREE_MARGIN, AABB_TREE_MARGIN, AABB_TREE_MARGIN));
+			InsertLeaf(i);
+			++m_numReinserted;
+		}
+	}
+}
+
+void DynamicAABBTree::GenPairs(std::vector<CollisionPair>& colPairs)
+{
+	if (m_root == AABB_TREE_NULL)
+	{
+		return;
+	}
+
+	const int numNodes = (int)m_nodes.size();
+	for (int i = 0; i < numNodes; ++i)
+	{
+		if (m_nodes[i].height != 0)
+		{
+			continue;
+		}
+
+		const BoundingBox& bounds = m_tightBounds[i];
+
+		m_stack.clear();
+		m_stack.push_back(m_root);
+		while (!m_stack.empty())
+		{
+			int node = m_stack.back();
+			m_stack.pop_back();
+
+			if (!m_nodes[node].bounds.Intersects(bounds))
+			{
+				continue;
+			}
+
+			if (m_nodes[node].IsLeaf())
+			{
+				//Each pair is found by both of its leaves, so only keep the one found by the lower index
+				if (node > i && m_tightBounds[node].Intersects(bounds)
+					&& IsBroadphasePair(m_nodes[i].pNode, m_nodes[node].pNode))
+				{
+					CollisionPair cp;
+					cp.pObjectA = m_nodes[i].pNode;
+					cp.pObjectB = m_nodes[node].pNode;
+					colPairs.push_back(cp);
+				}
+			}
+			else
+			{
+				m_stack.push_back(m_nodes[node].child1);
+				m_stack.push_back(m_nodes[node].child2);
+			}
+		}
+	}
+}
+
+void DynamicAABBTree::Query(const BoundingBox& bounds, std::vector<PhysicsNode*>& out_nodes)
+{
+	if (m_root == AABB_TREE_NULL)
+	{
+		return;
+	}
+
+	m_stack.clear();
+	m_stack.push_back(m_root);
+	while (!m_stack.empty())
+	{
+		int node = m_stack.back();
+		m_stack.pop_back();
+
+		if (!m_nodes[node].bounds.Intersects(bounds))
+		{
+			continue;
+		}
+
+		if (m_nodes[node].IsLeaf())
+		{
+			out_nodes.push_back(m_nodes[node].pNode);
+		}
+		else
+		{
+			m_stack.push_back(m_nodes[node].child1);
+			m_stack.push_back(m_nodes[node].child2);
+		}
+	}
+}
+
+void DynamicAABBTree::DebugDraw()
+{
+	if (m_root != AABB_TREE_NULL)
+	{
+		DebugDrawNode(m_root, 0);
+	}
+}
+
+int DynamicAABBTree::AllocateNode()
+{
+	int node;
+	if (m_freeList != AABB_TREE_NULL)
+	{
+		node = m_freeList;
+		m_freeList = m_nodes[node].parent;
+	}
+	else
+	{
+		node = (int)m_nodes.size();
+		m_nodes.push_back(TreeNode());
+	}
+
+	TreeNode& n = m_nodes[node];
+	n.parent = AABB_TREE_NULL;
+	n.child1 = AABB_TREE_NULL;
+	n.child2 = AABB_TREE_NULL;
+	n.height = 0;
+	n.pNode = NULL;
+	return node;
+}
+
+void DynamicAABBTree::FreeNode(int node)
+{
+	m_nodes[node].parent = m_freeList;
+	m_nodes[node].height = -1;
+	m_nodes[node].pNode = NULL;
+	m_freeList = node;
+}
+
+void DynamicAABBTree::InsertLeaf(int leaf)
+{
+	if (m_root == AABB_TREE_NULL)
+	{
+		m_root = leaf;
+		m_nodes[leaf].parent = AABB_TREE_NULL;
+		return;
+	}
+
+	//Find the best sibling for the new leaf
+	//At each level the leaf can either be paired with the current node or pushed down into one of its
+	//children. The cost of each option is the surface area it adds to the tree.
+	const BoundingBox leafBounds = m_nodes[leaf].bounds;
+	int index = m_root;
+	while (!m_nodes[index].IsLeaf())
+	{
+		int child1 = m_nodes[index].child1;
+		int child2 = m_nodes[index].child2;
+
+		float area = m_nodes[index].bounds.SurfaceArea();
+		float combinedArea = Union(m_nodes[index].bounds, leafBounds).SurfaceArea();
+
+		//Cost of creating a new parent for this node and the new leaf
+		float cost = 2.0f * combinedArea;
+
+		//Minimum cost of pushing the leaf further down the tree
+		float inheritanceCost = 2.0f * (combinedArea - area);
+
+		float cost1 = Union(m_nodes[child1].bounds, leafBounds).SurfaceArea() + inheritanceCost;
+		if (!m_nodes[child1].IsLeaf())
+		{
+			cost1 -= m_nodes[child1].bounds.SurfaceArea();
+		}
+
+		float cost2 = Union(m_nodes[child2].bounds, leafBounds).SurfaceArea() + inheritanceCost;
+		if (!m_nodes[child2].IsLeaf())
+		{
+			cost2 -= m_nodes[child2].bounds.SurfaceArea();
+		}
+
+		if (cost < cost1 && cost < cost2)
+		{
+			break;
+		}
+
+		index = cost1 < cost2 ? child1 : child2;
+	}
+
+	//Create a new parent for the sibling and the leaf
+	int sibling = index;
+	int oldParent = m_nodes[sibling].parent;
+	int newParent = AllocateNode();
+	m_nodes[newParent].parent = oldParent;
+	m_nodes[newParent].bounds = Union(leafBounds, m_nodes[sibling].bounds);
+	m_nodes[newParent].height = m_nodes[sibling].height + 1;
+	m_nodes[newParent].child1 = sibling;
+	m_nodes[newParent].child2 = leaf;
+	m_nodes[sibling].parent = newParent;
+	m_nodes[leaf].parent = newParent;
+
+	if (oldParent != AABB_TREE_NULL)
+	{
+		if (m_nodes[oldParent].child1 == sibling)
+		{
+			m_nodes[oldParent].child1 = newParent;
+		}
+		else
+		{
+			m_nodes[oldParent].child2 = newParent;
+		}
+	}
+	else
+	{
+		m_root = newParent;
+	}
+
+	//Walk back up the tree fixing heights and bounds
+	FixUpwards(newParent);
+}
+
+void DynamicAABBTree::RemoveLeaf(int leaf)
+{
+	if (leaf == m_root)
+	{
+		m_root = AABB_TREE_NULL;
+		return;
+	}
+
+	int parent = m_nodes[leaf].parent;
+	int grandParent = m_nodes[parent].parent;
+	int sibling = m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+	//Replace the parent with the sibling
+	if (grandParent != AABB_TREE_NULL)
+	{
+		if (m_nodes[grandParent].child1 == parent)
+		{
+			m_nodes[grandParent].child1 = sibling;
+		}
+		else
+		{
+			m_nodes[grandParent].child2 = sibling;
+		}
+		m_nodes[sibling].parent = grandParent;
+		FreeNode(parent);
+
+		FixUpwards(grandParent);
+	}
+	else
+	{
+		m_root = sibling;
+		m_nodes[sibling].parent = AABB_TREE_NULL;
+		FreeNode(parent);
+	}
+
+	m_nodes[leaf].parent = AABB_TREE_NULL;
+}
+
+void DynamicAABBTree::FixUpwards(int node)
+{
+	while (node != AABB_TREE_NULL)
+	{
+		node = Balance(node);
+
+		TreeNode& n = m_nodes[node];
+		n.height = 1 + max(m_nodes[n.child1].height, m_nodes[n.child2].height);
+		n.bounds = Union(m_nodes[n.child1].bounds, m_nodes[n.child2].bounds);
+
+		node = n.parent;
+	}
+}
+
+int DynamicAABBTree::Balance(int iA)
+{
+	/*
+	*	        A
+	*	      /   \
+	*	     B     C
+	*	    / \   / \
+	*	   D   E F   G
+	*/
+
+	TreeNode& A = m_nodes[iA];
+	if (A.IsLeaf() || A.height < 2)
+	{
+		return iA;
+	}
+
+	int iB = A.child1;
+	int iC = A.child2;
+	TreeNode& B = m_nodes[iB];
+	TreeNode& C = m_nodes[iC];
+
+	int balance = C.height - B.height;
+
+	//Rotate C up
+	if (balance > 1)
+	{
+		int iF = C.child1;
+		int iG = C.child2;
+		TreeNode& F = m_nodes[iF];
+		TreeNode& G = m_nodes[iG];
+
+		//Swap A and C
+		C.child1 = iA;
+		C.parent = A.parent;
+		A.parent = iC;
+
+		//A's old parent should point to C
+		if (C.parent != AABB_TREE_NULL)
+		{
+			if (m_nodes[C.parent].child1 == iA)
+			{
+				m_nodes[C.parent].child1 = iC;
+			}
+			else
+			{
+				m_nodes[C.parent].child2 = iC;
+			}
+		}
+		else
+		{
+			m_root = iC;
+		}
+
+		//Keep the taller of F and G under C and move the other under A
+		if (F.height > G.height)
+		{
+			C.child2 = iF;
+			A.child2 = iG;
+			G.parent = iA;
+			A.bounds = Union(B.bounds, G.bounds);
+			C.bounds = Union(A.bounds, F.bounds);
+			A.height = 1 + max(B.height, G.height);
+			C.height = 1 + max(A.height, F.height);
+		}
+		else
+		{
+			C.child2 = iG;
+			A.child2 = iF;
+			F.parent = iA;
+			A.bounds = Union(B.bounds, F.bounds);
+			C.bounds = Union(A.bounds, G.bounds);
+			A.height = 1 + max(B.height, F.height);
+			C.height = 1 + max(A.height, G.height);
+		}
+
+		return iC;
+	}
+
+	//Rotate B up
+	if (balance < -1)
+	{
+		int iD = B.child1;
+		int iE = B.child2;
+		TreeNode& D = m_nodes[iD];
+		TreeNode& E = m_nodes[iE];
+
+		//Swap A and B
+		B.child1 = iA;
+		B.parent = A.parent;
+		A.parent = iB;
+
+		//A's old parent should point to B
+		if (B.parent != AABB_TREE_NULL)
+		{
+			if (m_nodes[B.parent].child1 == iA)
+			{
+				m_nodes[B.parent].child1 = iB;
+			}
+			else
+			{
+				m_nodes[B.parent].child2 = iB;
+			}
+		}
+		else
+		{
+			m_root = iB;
+		}
+
+		//Keep the taller of D and E under B and move the other under A
+		if (D.height > E.height)
+		{
+			B.child2 = iD;
+			A.child1 = iE;
+			E.parent = iA;
+			A.bounds = Union(C.bounds, E.bounds);
+			B.bounds = Union(A.bounds, D.bounds);
+			A.height = 1 + max(C.height, E.height);
+			B.height = 1 + max(A.height, D.height);
+		}
+		else
+		{
+			B.child2 = iE;
+			A.child1 = iD;
+			D.parent = iA;
+			A.bounds = Union(C.bounds, D.bounds);
+			B.bounds = Union(A.bounds, E.bounds);
+			A.height = 1 + max(C.height, D.height);
+			B.height = 1 + max(A.height, E.height);
+		}
+
+		return iB;
+	}
+
+	return iA;
+}
+
+void DynamicAABBTree::DebugDrawNode(int node, int depth)
+{
+	const TreeNode& n = m_nodes[node];
+
+	//Leaves are drawn green, internal nodes fade from red at the root to yellow further down
+	Vector4 colour = n.IsLeaf() ? Vector4(0.0f, 1.0f, 0.0f, 1.0f) : Vector4(1.0f, min(depth * 0.1f, 1.0f), 0.0f, 1.0f);
+
+	const Vector3& lo = n.bounds._min;
+	const Vector3& hi = n.bounds._max;
+	Vector3 corners[8] = {
+		Vector3(lo.x, lo.y, lo.z), Vector3(hi.x, lo.y, lo.z), Vector3(hi.x, hi.y, lo.z), Vector3(lo.x, hi.y, lo.z),
+		Vector3(lo.x, lo.y, hi.z), Vector3(hi.x, lo.y, hi.z), Vector3(hi.x, hi.y, hi.z), Vector3(lo.x, hi.y, hi.z)
+	};
+
+	for (int i = 0; i < 4; ++i)
+	{
+		NCLDebug::DrawHairLine(corners[i], corners[(i + 1) % 4], colour);
+		NCLDebug::DrawHairLine(corners[i + 4], corners[(i + 1) % 4 + 4], colour);
+		NCLDebug::DrawHairLine(corners[i], corners[i + 4], colour);
+	}
+
+	if (!n.IsLeaf())
+	{
+		DebugDrawNode(n.child1, depth + 1);
+		DebugDrawNode(n.child2, depth + 1);
+	}
+}
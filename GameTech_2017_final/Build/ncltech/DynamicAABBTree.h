@@ -0,0 +1,89 @@
+#pragma once
+
+#include "PhysicsNode.h"
+#include "BoundingBox.h"
+#include <vector>
+#include <unordered_map>
+
+//Dynamic bounding volume hierarchy broadphase
+//
+//Every physics node is a leaf of a binary tree of axis aligned bounding boxes, where each internal node's box
+//encloses both of its children. Unlike the octree there are no world bounds, so it works for any size of scene
+//and copes well with objects of very different sizes.
+//
+//Leaves store a 'fat' AABB, the node's bounds expanded by AABB_TREE_MARGIN. A node is only removed and
+//reinserted when its bounds leave its fat AABB, so objects that are resting or moving slowly never touch the
+//tree. Inserting picks the sibling that increases the total surface area of the tree the least, and the tree
+//is kept balanced with rotations on the way back up to the root.
+
+#define AABB_TREE_MARGIN 0.1f		//Distance the fat AABBs extend past a node's bounds
+#define AABB_TREE_NULL -1			//Index of a node that doesn't exist
+
+class DynamicAABBTree
+{
+public:
+	DynamicAABBTree();
+	DynamicAABBTree(std::vector<PhysicsNode*>& pNodes);
+	~DynamicAABBTree();
+
+	//Add/remove a single node
+	void InsertObject(PhysicsNode* pNode);
+	void RemoveObject(PhysicsNode* pNode);
+	void Clear();
+
+	//Reinsert any nodes that have moved outside of their fat AABBs
+	void UpdateObjects();
+
+	//Query the tree with each physics node to find all the overlapping pairs
+	void GenPairs(std::vector<CollisionPair>& colPairs);
+
+	//Find every physics node whose fat AABB overlaps the given box
+	void Query(const BoundingBox& bounds, std::vector<PhysicsNode*>& out_nodes);
+
+	void DebugDraw();
+
+	//Height of the root node, a perfectly balanced tree has a height of log2(n)
+	inline int GetHeight() const { return m_root == AABB_TREE_NULL ? 0 : m_nodes[m_root].height; }
+
+	//Number of nodes reinserted during the last update
+	inline int GetNumReinserted() const { return m_numReinserted; }
+
+protected:
+	struct TreeNode
+	{
+		BoundingBox		bounds;			//Fat AABB for leaves, the union of the children for internal nodes
+		int				parent;			//Also used as the next free node when the node is in the free list
+		int				child1;
+		int				child2;
+		int				height;			//0 for leaves, -1 for free nodes
+		PhysicsNode*	pNode;			//Leaves only
+
+		inline bool IsLeaf() const { return child1 == AABB_TREE_NULL; }
+	};
+
+	//Node pool
+	int AllocateNode();
+	void FreeNode(int node);
+
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+
+	//Perform a left or right rotation if node A is imbalanced
+	//Returns the new root index of the sub tree
+	int Balance(int iA);
+
+	//Recompute the bounds and heights from the node up to the root, rebalancing as it goes
+	void FixUpwards(int node);
+
+	void DebugDrawNode(int node, int depth);
+
+	std::vector<TreeNode> m_nodes;
+	int m_root = AABB_TREE_NULL;
+	int m_freeList = AABB_TREE_NULL;
+
+	std::unordered_map<PhysicsNode*, int> m_leaves;	//Leaf node of each physics node
+	std::vector<BoundingBox> m_tightBounds;				//Bounds of each leaf's physics node this update, indexed by node
+	std::vector<int> m_stack;							//Traversal stack, kept between queries so it doesn't need reallocating
+
+	int m_numReinserted = 0;
+};
@@ -0,0 +1,72 @@
+#include "FrameArena.h"
+#include <new>
+
+FrameArena::FrameArena(size_t initialSize)
+	: offset(0)
+	, capacity(0)
+	, numAllocations(0)
+	, bytesAllocated(0)
+{
+	AddBlock(initialSize);
+}
+
+FrameArena::~FrameArena()
+{
+	for (Block& block : blocks)
+	{
+		::operator delete(block.memory);
+	}
+}
+
+void FrameArena::AddBlock(size_t minBytes)
+{
+	//Grow geometrically so an update that overflows only adds a few blocks
+	const size_t lastSize = blocks.empty() ? 0 : blocks.back().size;
+	const size_t size = (minBytes > lastSize * 2) ? minBytes : lastSize * 2;
+
+	Block block;
+	block.memory = static_cast<char*>(::operator new(size));
+	block.size = size;
+	blocks.push_back(block);
+
+	offset = 0;
+	capacity += size;
+}
+
+void* FrameArena::Allocate(size_t bytes, size_t alignment)
+{
+	//Round the offset up to the alignment (always a power of two)
+	size_t start = (offset + alignment - 1) & ~(alignment - 1);
+	if (start + bytes > blocks.back().size)
+	{
+		//New blocks come from operator new, so are aligned for anything
+		AddBlock(bytes);
+		start = 0;
+	}
+
+	offset = start + bytes;
+	numAllocations++;
+	bytesAllocated += bytes;
+	return blocks.back().memory + start;
+}
+
+void FrameArena::Reset()
+{
+	//Replace the blocks with one that can hold everything, so the next update of the same size fits in one block
+	if (blocks.size() > 1)
+	{
+		for (Block& block : blocks)
+		{
+			::operator delete(block.memory);
+		}
+		blocks.clear();
+
+		const size_t total = capacity;
+		capacity = 0;
+		AddBlock(total);
+	}
+
+	offset = 0;
+	numAllocations = 0;
+	bytesAllocated = 0;
+}
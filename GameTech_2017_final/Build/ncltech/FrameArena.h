@@ -0,0 +1,101 @@
+#pragma once
+
+#include <vector>
+#include <list>
+#include <cstddef>
+
+//Linear (bump) allocator for data that only lives for a single physics update
+//
+//Allocating is just rounding up and moving an offset along a block of memory, and nothing is freed individually,
+//the whole arena is emptied at once by Reset() at the start of each update. If an update needs more than the block
+//holds, extra blocks are added and then merged into a single larger block on the next Reset(), so once the arena
+//has grown to fit the largest update it never touches the heap again.
+//
+//Each arena is only used by one thread at a time, the physics engine keeps one per narrowphase thread.
+
+#define FRAME_ARENA_DEFAULT_SIZE (64 * 1024)
+
+class FrameArena
+{
+public:
+	FrameArena(size_t initialSize = FRAME_ARENA_DEFAULT_SIZE);
+	~FrameArena();
+
+	void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+	//Frees everything allocated since the last reset, and resets the counters
+	// - Nothing allocated from the arena can be used after this
+	void Reset();
+
+	//Counters since the last reset
+	inline size_t GetNumAllocations() const		{ return numAllocations; }
+	inline size_t GetBytesAllocated() const		{ return bytesAllocated; }
+
+	//Total size of the blocks held by the arena
+	inline size_t GetCapacity() const			{ return capacity; }
+
+protected:
+	//Start a new block that can hold at least the given number of bytes
+	void AddBlock(size_t minBytes);
+
+	struct Block
+	{
+		char*	memory;
+		size_t	size;
+	};
+
+	std::vector<Block>	blocks;
+	size_t				offset;				//Offset of the next free byte in the last block
+	size_t				capacity;
+
+	size_t				numAllocations;
+	size_t				bytesAllocated;
+
+private:
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+};
+
+
+//Standard library allocator that takes its memory from a FrameArena, so temporary containers can be used in the
+//physics update without going to the heap
+// - Deallocating does nothing, the memory is reclaimed when the arena is reset
+// - A default constructed allocator has no arena and falls back to the heap, so anything using the arena containers
+//   still works when called from outside a physics update
+template <typename T>
+class ArenaAllocator
+{
+public:
+	typedef T value_type;
+
+	ArenaAllocator() : arena(NULL) {}
+	ArenaAllocator(FrameArena* arena) : arena(arena) {}
+
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+	T* allocate(size_t n)
+	{
+		return arena
+			? static_cast<T*>(arena->Allocate(n * sizeof(T), alignof(T)))
+			: static_cast<T*>(::operator new(n * sizeof(T)));
+	}
+
+	void deallocate(T* ptr, size_t)
+	{
+		if (!arena) ::operator delete(ptr);
+	}
+
+	template <typename U>
+	inline bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+	template <typename U>
+	inline bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+
+	FrameArena* arena;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+template <typename T>
+using ArenaList = std::list<T, ArenaAllocator<T>>;
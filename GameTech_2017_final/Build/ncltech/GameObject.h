@@ -14,8 +14,8 @@ position/orientation each frame.
 
 *//////////////////////////////////////////////////////////////////////////////
 #pragma once
-#include <nclgl\Matrix4.h>
-#include <nclgl\RenderNode.h>
+#include <nclgl/Matrix4.h>
+#include <nclgl/RenderNode.h>
 #include "GraphicsPipeline.h"
 #include "PhysicsEngine.h"
 #include "PhysicsNode.h"
@@ -48,10 +48,13 @@ public:
 	virtual ~GameObject()
 	{
 		if (renderNode)  GraphicsPipeline::Instance()->RemoveRenderNode(renderNode);
-		if (physicsNode) PhysicsEngine::Instance()->RemovePhysicsObject(physicsNode);
+
+		//The physics engine deletes the node itself, holding on to it until the end of the update if a collision
+		// callback got us here
+		if (physicsNode) PhysicsEngine::Instance()->DeletePhysicsObject(physicsNode);
+		physicsNode = NULL;
 
 		SAFE_DELETE(renderNode);
-		SAFE_DELETE(physicsNode);
 	}
 
 
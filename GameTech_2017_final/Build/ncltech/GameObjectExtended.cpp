@@ -12,8 +12,8 @@ GameObjectExtended::~GameObjectExtended()
 {
 	for (int i = 1; i < m_physicsNodes.size(); ++i)
 	{
-		if (m_physicsNodes[i]) PhysicsEngine::Instance()->RemovePhysicsObject(m_physicsNodes[i]);
-		SAFE_DELETE(m_physicsNodes[i]);
+		if (m_physicsNodes[i]) PhysicsEngine::Instance()->DeletePhysicsObject(m_physicsNodes[i]);
+		m_physicsNodes[i] = NULL;
 	}
 
 	if (renderNode)  GraphicsPipeline::Instance()->RemoveRenderNode(renderNode);
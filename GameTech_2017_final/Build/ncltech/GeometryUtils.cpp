@@ -1,5 +1,5 @@
 #include "GeometryUtils.h"
-#include <nclgl\common.h>
+#include <nclgl/common.h>
 
 // Gets the closest point x on the line (edge) to point (pos)
 Vector3 GeometryUtils::GetClosestPoint(
@@ -36,7 +36,7 @@ Vector3 GeometryUtils::GetClosestPoint(
 // resides on any of the given edges of the polygon.
 Vector3 GeometryUtils::GetClosestPointPolygon(
 	const Vector3& pos,
-	const std::list<Vector3>& polygon)
+	const ArenaList<Vector3>& polygon)
 {
 	Vector3 final_closest_point = Vector3(0.0f, 0.0f, 0.0f);
 	float final_closest_distsq = FLT_MAX;
@@ -129,10 +129,10 @@ bool GeometryUtils::PlaneEdgeIntersection(
 //Performs sutherland hodgman clipping algorithm to clip the provided mesh
 //    or polygon in regards to each of the provided clipping planes.
 void GeometryUtils::SutherlandHodgmanClipping(
-	const std::list<Vector3>& input_polygon,
+	const ArenaList<Vector3>& input_polygon,
 	int num_clip_planes,
 	const Plane* clip_planes,
-	std::list<Vector3>* out_polygon,
+	ArenaList<Vector3>* out_polygon,
 	bool removeNotClipToPlane)
 {
 	if (!out_polygon)
@@ -143,8 +143,9 @@ void GeometryUtils::SutherlandHodgmanClipping(
 
 	//Create temporary list of vertices
 	// - We will keep ping-pong'ing between the two lists updating them as we go.
-	std::list<Vector3> ppPolygon1, ppPolygon2;
-	std::list<Vector3> *input = &ppPolygon1, *output = &ppPolygon2;
+	// - They share the input polygon's allocator, so come out of the same frame arena
+	ArenaList<Vector3> ppPolygon1(input_polygon.get_allocator()), ppPolygon2(input_polygon.get_allocator());
+	ArenaList<Vector3> *input = &ppPolygon1, *output = &ppPolygon2;
 
 	*input = input_polygon;
 
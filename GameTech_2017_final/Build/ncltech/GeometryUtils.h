@@ -1,6 +1,7 @@
 #pragma once
-#include <nclgl\Vector3.h>
-#include <nclgl\Plane.h>
+#include <nclgl/Vector3.h>
+#include <nclgl/Plane.h>
+#include "FrameArena.h"
 #include <list>
 #include <vector>
 
@@ -28,7 +29,7 @@ namespace GeometryUtils
 	// resides on any of the given edges of the polygon.
 	Vector3 GetClosestPointPolygon(
 		const Vector3& pos,
-		const std::list<Vector3>& polygon);
+		const ArenaList<Vector3>& polygon);
 
 	// Iterates through all edges returning the the point X which is the closest
 	//   point along any of the given edges to the provided point A as possible.
@@ -49,9 +50,9 @@ namespace GeometryUtils
 	// in regards to each of the provided clipping planes.
 	// https://en.wikipedia.org/wiki/Sutherland%E2%80%93Hodgman_algorithm
 	void SutherlandHodgmanClipping(
-		const std::list<Vector3>& input_polygon,
+		const ArenaList<Vector3>& input_polygon,
 		int num_clip_planes,
 		const Plane* clip_planes,
-		std::list<Vector3>* out_polygon,
+		ArenaList<Vector3>* out_polygon,
 		bool removeNotClipToPlane);
 };
\ No newline at end of file
@@ -1,7 +1,7 @@
 #include "GraphicsPipeline.h"
 #include "ScreenPicker.h"
 #include "BoundingBox.h"
-#include <nclgl\NCLDebug.h>
+#include <nclgl/NCLDebug.h>
 #include <algorithm>
 
 GraphicsPipeline::GraphicsPipeline()
@@ -1,8 +1,8 @@
 #pragma once
-#include <nclgl\OGLRenderer.h>
-#include <nclgl\TSingleton.h>
-#include <nclgl\Camera.h>
-#include <nclgl\RenderNode.h>
+#include <nclgl/OGLRenderer.h>
+#include <nclgl/TSingleton.h>
+#include <nclgl/Camera.h>
+#include <nclgl/RenderNode.h>
 
 //---------------------------
 //------ Base Renderer ------
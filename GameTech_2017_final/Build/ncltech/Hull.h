@@ -15,7 +15,7 @@ Description:
 
 	They can be quite useful for debugging shapes and experimenting with new 3D algorithms. 
 	In this framework they are used to represent discrete collision shapes which have distinct non-curved, 
-	faces (see CuboidCollisionShape). 
+	faces (see CuboidCollisionShape and ConvexHullCollisionShape). 
 
 	Note: One of the big changes from the graphics Mesh class is that the faces can have any number of vertices,
 	so you could represent your mesh as a series of triangles, pentagons, quads etc or any combination of these.
@@ -24,8 +24,8 @@ Description:
 
 #pragma once
 
-#include <nclgl\Vector3.h>
-#include <nclgl\Matrix4.h>
+#include <nclgl/Vector3.h>
+#include <nclgl/Matrix4.h>
 #include <vector>
 
 struct HullEdge;
@@ -65,14 +65,14 @@ public:
 	Hull();
 	~Hull();
 
-	void DebugDraw(const Matrix4& transform);
+	void DebugDraw(const Matrix4& transform) const;
 	void Clear();
 
 
 	int AddVertex(const Vector3& v);
 
 	int AddFace(const Vector3& _normal, int nVerts, const int* verts);
-	int AddFace(const Vector3& _normal, const std::vector<int>& vert_ids)		{ AddFace(_normal, (int)vert_ids.size(), &vert_ids[0]); }
+	int AddFace(const Vector3& _normal, const std::vector<int>& vert_ids)		{ return AddFace(_normal, (int)vert_ids.size(), &vert_ids[0]); }
 
 	
 	void RemoveFace(int faceidx);
@@ -82,16 +82,24 @@ public:
 	int FindEdge(int v0_idx, int v1_idx);
 	
 
-	const HullVertex& GetVertex(int idx)		{ return m_vVertices[idx]; }
-	const HullEdge& GetEdge(int idx)			{ return m_vEdges[idx]; }
-	const HullFace& GetFace(int idx)			{ return m_vFaces[idx]; }
+	const HullVertex& GetVertex(int idx) const	{ return m_vVertices[idx]; }
+	const HullEdge& GetEdge(int idx) const		{ return m_vEdges[idx]; }
+	const HullFace& GetFace(int idx) const		{ return m_vFaces[idx]; }
 
-	size_t GetNumVertices()					{ return m_vVertices.size(); }
-	size_t GetNumEdges()					{ return m_vEdges.size(); }
-	size_t GetNumFaces()					{ return m_vFaces.size(); }
+	size_t GetNumVertices() const			{ return m_vVertices.size(); }
+	size_t GetNumEdges() const				{ return m_vEdges.size(); }
+	size_t GetNumFaces() const				{ return m_vFaces.size(); }
 
 
-	void GetMinMaxVerticesInAxis(const Vector3& local_axis, int* out_min_vert, int* out_max_vert);
+	void GetMinMaxVerticesInAxis(const Vector3& local_axis, int* out_min_vert, int* out_max_vert) const;
+
+	//Hill climbs from the given vertex to the furthest vertex along the axis, each step moving to whichever
+	// vertex sharing a face with it is furthest along it. On a convex hull the first vertex with no better
+	// neighbour is always the furthest one, and starting near the answer (e.g. last query's result) means only
+	// a handful of vertices are visited however many the hull has.
+	// - Whole faces are checked rather than just edges so the climb can't get stuck on a face that is only
+	//   planar to within a tolerance, where a vertex along its edge can bend back below its neighbours
+	int GetFurthestVertexInAxis(const Vector3& local_axis, int start_vert) const;
 
 	int ConstructNewEdge(int parent_face_idx, int vert_start, int vert_end); //Called by AddFace
 	
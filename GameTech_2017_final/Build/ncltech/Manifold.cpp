@@ -1,12 +1,17 @@
 #include "Manifold.h"
-#include <nclgl\Matrix3.h>
-#include <nclgl\NCLDebug.h>
+#include <nclgl/Matrix3.h>
+#include <nclgl/NCLDebug.h>
 #include "PhysicsEngine.h"
 #include <algorithm>
 
 Manifold::Manifold()
 	: pnodeA(NULL)
 	, pnodeB(NULL)
+	, numContacts(0)
+	, numOldContacts(0)
+	, bodyA(0)
+	, bodyB(0)
+	, frictionCoef(0.0f)
 {
 }
 
@@ -17,54 +22,79 @@ Manifold::~Manifold()
 
 void Manifold::Initiate(PhysicsNode* nodeA, PhysicsNode* nodeB)
 {
-	contactPoints.clear();
+	//If the pair has been found the other way around the old contacts don't match up so they are dropped
+	if (nodeA == pnodeA && nodeB == pnodeB)
+	{
+		for (unsigned int i = 0; i < numContacts; ++i)
+		{
+			oldContactPoints[i] = contactPoints[i];
+		}
+		numOldContacts = numContacts;
+	}
+	else
+	{
+		numOldContacts = 0;
+	}
+	numContacts = 0;
 
 	pnodeA = nodeA;
 	pnodeB = nodeB;
 }
 
-void Manifold::ApplyImpulse()
+void Manifold::Reset()
+{
+	pnodeA = NULL;
+	pnodeB = NULL;
+	numContacts = 0;
+	numOldContacts = 0;
+}
+
+float Manifold::ApplyImpulse(SolverBodies& bodies)
 {
-	for (ContactPoint& contact : contactPoints)
+	float residual = 0.0f;
+	for (unsigned int i = 0; i < numContacts; ++i)
 	{
-		SolveContactPoint(contact);
+		const float contactResidual = SolveContactPoint(bodies, contactPoints[i]);
+		residual = max(residual, contactResidual);
 	}
+	return residual;
 }
 
 
-void Manifold::SolveContactPoint(ContactPoint& c)
+float Manifold::SolveContactPoint(SolverBodies& bodies, ContactPoint& c)
 {
+	//Change in the accumulated impulses, these are stored before dividing by the constraint mass so
+	// are in terms of relative velocity
+	float residual = 0.0f;
+
 	/* TUTORIAL 6 CODE */
 	Vector3 r1 = c.relPosA;
 	Vector3 r2 = c.relPosB;
 
-	Vector3 v0 = pnodeA->GetLinearVelocity() + Vector3::Cross(pnodeA->GetAngularVelocity(), r1);
-	Vector3 v1 = pnodeB->GetLinearVelocity() + Vector3::Cross(pnodeB->GetAngularVelocity(), r2);
+	Vector3 v0 = bodies.GetVelocityAt(bodyA, r1);
+	Vector3 v1 = bodies.GetVelocityAt(bodyB, r2);
 
 	Vector3 dv = v1 - v0;
 
 
 	//Collision Resolution
-	float constraintMass = (pnodeA->GetInverseMass() + pnodeB->GetInverseMass()) +
-		Vector3::Dot(c.colNormal,
-			Vector3::Cross(pnodeA->GetInverseInertia()*Vector3::Cross(r1, c.colNormal), r1) +
-			Vector3::Cross(pnodeB->GetInverseInertia()*Vector3::Cross(r2, c.colNormal), r2));
+	float constraintMass = bodies.ComputeConstraintMass(bodyA, bodyB, r1, r2, c.colNormal);
 
 	if (constraintMass > 0.0f)
 	{
-		float jn = max(-Vector3::Dot(dv, c.colNormal) + c.b_term, 0.0f);
+		//jn is allowed to be negative here, only the total impulse is clamped. This lets the solver take back
+		// any impulse carried over from the last step that is more than the contact needs this step.
+		float jn = -Vector3::Dot(dv, c.colNormal) + c.b_term;
 
 		float oldSumImpulseContact = c.sumImpulseContact;
 		c.sumImpulseContact = max(c.sumImpulseContact + jn, 0.0f);
 		jn = c.sumImpulseContact - oldSumImpulseContact;
+		residual = fabs(jn);
 
 		jn = jn / constraintMass;
 
-		pnodeA->SetLinearVelocity(pnodeA->GetLinearVelocity() - c.colNormal*(jn * pnodeA->GetInverseMass()));
-		pnodeB->SetLinearVelocity(pnodeB->GetLinearVelocity() + c.colNormal*(jn * pnodeB->GetInverseMass()));
-
-		pnodeA->SetAngularVelocity(pnodeA->GetAngularVelocity() - pnodeA->GetInverseInertia()* Vector3::Cross(r1, c.colNormal * jn));
-		pnodeB->SetAngularVelocity(pnodeB->GetAngularVelocity() + pnodeB->GetInverseInertia()* Vector3::Cross(r2, c.colNormal * jn));
+		bodies.ApplyImpulse(bodyA, -c.colNormal * jn, r1);
+		bodies.ApplyImpulse(bodyB, c.colNormal * jn, r2);
 	}
 
 
@@ -77,14 +107,10 @@ void Manifold::SolveContactPoint(ContactPoint& c)
 	{
 		tangent = tangent / tangent_len;
 
-		float frictionalMass = (pnodeA->GetInverseMass() + pnodeB->GetInverseMass()) +
-			Vector3::Dot(tangent,
-				Vector3::Cross(pnodeA->GetInverseInertia()* Vector3::Cross(r1, tangent), r1) +
-				Vector3::Cross(pnodeB->GetInverseInertia()* Vector3::Cross(r2, tangent), r2));
+		float frictionalMass = bodies.ComputeConstraintMass(bodyA, bodyB, r1, r2, tangent);
 
 		if (frictionalMass > 0.0f)
 		{
-			float frictionCoef = (pnodeA->GetFriction() * pnodeB->GetFriction());
 			float jt = -Vector3::Dot(dv, tangent) * frictionCoef;
 
 			//Stop Friction from ever being more than frictionCoef * normal resolution impulse
@@ -102,34 +128,34 @@ void Manifold::SolveContactPoint(ContactPoint& c)
 				c.sumImpulseFriction = c.sumImpulseFriction / len * c.sumImpulseContact;
 			}
 			tangent = c.sumImpulseFriction - oldImpulseFriction;
+			residual = max(residual, tangent.Length());
 			jt = 1.0f;
 
 			jt = jt / frictionalMass;
 
-			pnodeA->SetLinearVelocity(pnodeA->GetLinearVelocity() - tangent*(jt*pnodeA->GetInverseMass()));
-			pnodeB->SetLinearVelocity(pnodeB->GetLinearVelocity() + tangent*(jt*pnodeB->GetInverseMass()));
-
-			pnodeA->SetAngularVelocity(pnodeA->GetAngularVelocity() - pnodeA->GetInverseInertia()* Vector3::Cross(r1, tangent*jt));
-			pnodeB->SetAngularVelocity(pnodeB->GetAngularVelocity() + pnodeB->GetInverseInertia()* Vector3::Cross(r2, tangent*jt));
+			bodies.ApplyImpulse(bodyA, -tangent * jt, r1);
+			bodies.ApplyImpulse(bodyB, tangent * jt, r2);
 		}
 	}
 
+	return residual;
 }
 
 void Manifold::PreSolverStep(float dt)
 {
-	std::random_shuffle(contactPoints.begin(), contactPoints.end());
-	for (ContactPoint& contact : contactPoints)
+	bodyA = pnodeA->GetBodyIndex();
+	bodyB = pnodeB->GetBodyIndex();
+	frictionCoef = pnodeA->GetFriction() * pnodeB->GetFriction();
+
+	for (unsigned int i = 0; i < numContacts; ++i)
 	{
-		UpdateConstraint(contact);
+		UpdateConstraint(contactPoints[i]);
 	}
 }
 
 void Manifold::UpdateConstraint(ContactPoint& c)
 {
-	//Reset total impulse forces computed this physics timestep 
-	c.sumImpulseContact = 0.0f;
-	c.sumImpulseFriction = Vector3(0.0f, 0.0f, 0.0f);
+	//The total impulse forces are not reset here, they start from the values carried over from the last step in AddContact
 	c.b_term = 0.0f;
 
 	/* TUTORIAL 6 CODE */
@@ -159,7 +185,7 @@ void Manifold::UpdateConstraint(ContactPoint& c)
 		- Vector3::Cross(c.relPosB, pnodeB->GetAngularVelocity())
 	);
 
-	c.b_term += (elasticity * elatisity_term) / contactPoints.size();
+	c.b_term += (elasticity * elatisity_term) / numContacts;
 
 }
 
@@ -178,29 +204,153 @@ void Manifold::AddContact(const Vector3& globalOnA, const Vector3& globalOnB, co
 	contact.colNormal.Normalise();
 	contact.colPenetration = penetration;
 
-	contactPoints.push_back(contact);
+	contact.b_term = 0.0f;
+	contact.sumImpulseContact = 0.0f;
+	contact.sumImpulseFriction = Vector3(0.0f, 0.0f, 0.0f);
+
+	//Match the contact to the closest contact from last step, if it's close enough and facing the same way
+	// it's treated as the same contact and its accumulated impulses are used as a starting point for the solver
+	ContactPoint* match = NULL;
+	float bestDistSq = CONTACT_MATCH_DISTANCE * CONTACT_MATCH_DISTANCE;
+	for (unsigned int i = 0; i < numOldContacts; ++i)
+	{
+		ContactPoint& oldContact = oldContactPoints[i];
+		Vector3 diff = oldContact.relPosA - r1;
+		float distSq = Vector3::Dot(diff, diff);
+		if (distSq < bestDistSq && Vector3::Dot(oldContact.colNormal, contact.colNormal) > 0.95f)
+		{
+			bestDistSq = distSq;
+			match = &oldContact;
+		}
+	}
+
+	if (match)
+	{
+		contact.sumImpulseContact = match->sumImpulseContact * WARM_START_FACTOR;
+
+		//Keep the friction in the plane of the new normal
+		Vector3 friction = match->sumImpulseFriction;
+		friction = friction - contact.colNormal * Vector3::Dot(friction, contact.colNormal);
+		contact.sumImpulseFriction = friction * WARM_START_FACTOR;
+
+		//Each old contact can only be carried over once, otherwise duplicate contacts from the clipping would double up its impulse
+		match->sumImpulseContact = 0.0f;
+		match->sumImpulseFriction = Vector3(0.0f, 0.0f, 0.0f);
+	}
+
+	if (numContacts < MANIFOLD_MAX_CONTACTS)
+	{
+		contactPoints[numContacts++] = contact;
+	}
+	else
+	{
+		const unsigned int replace = PickContactToReplace(contact);
+		if (replace < MANIFOLD_MAX_CONTACTS)
+		{
+			contactPoints[replace] = contact;
+		}
+	}
+}
+
+//Twice the area of the quad with the given corners, in whichever order gives the largest area
+static float QuadArea(const Vector3& p0, const Vector3& p1, const Vector3& p2, const Vector3& p3)
+{
+	const float a = Vector3::Cross(p0 - p1, p2 - p3).Length();
+	const float b = Vector3::Cross(p0 - p2, p1 - p3).Length();
+	const float c = Vector3::Cross(p0 - p3, p1 - p2).Length();
+	return max(a, max(b, c));
+}
+
+unsigned int Manifold::PickContactToReplace(const ContactPoint& contact) const
+{
+	//Candidates are the current contacts followed by the new one
+	const ContactPoint* candidates[MANIFOLD_MAX_CONTACTS + 1];
+	for (unsigned int i = 0; i < MANIFOLD_MAX_CONTACTS; ++i)
+	{
+		candidates[i] = &contactPoints[i];
+	}
+	candidates[MANIFOLD_MAX_CONTACTS] = &contact;
+
+	//The deepest contact is always kept (penetration is negative when overlapping)
+	unsigned int deepest = 0;
+	for (unsigned int i = 1; i <= MANIFOLD_MAX_CONTACTS; ++i)
+	{
+		if (candidates[i]->colPenetration < candidates[deepest]->colPenetration)
+		{
+			deepest = i;
+		}
+	}
+
+	//Drop whichever candidate leaves the other four enclosing the largest area
+	unsigned int drop = MANIFOLD_MAX_CONTACTS;
+	float bestArea = -1.0f;
+	for (unsigned int i = 0; i <= MANIFOLD_MAX_CONTACTS; ++i)
+	{
+		if (i == deepest)
+		{
+			continue;
+		}
 
+		const Vector3* kept[MANIFOLD_MAX_CONTACTS];
+		unsigned int numKept = 0;
+		for (unsigned int j = 0; j <= MANIFOLD_MAX_CONTACTS; ++j)
+		{
+			if (j != i) kept[numKept++] = &candidates[j]->relPosA;
+		}
+
+		const float area = QuadArea(*kept[0], *kept[1], *kept[2], *kept[3]);
+		if (area > bestArea)
+		{
+			bestArea = area;
+			drop = i;
+		}
+	}
 
-	//What a stupid function!
-	// - Manifold's normally persist over multiple frames, as in two colliding objects
-	//   (especially in the case of stacking) will likely be colliding in a similar 
-	//   setup the following couple of frames. So the accuracy therefore can be increased
-	//   by using persistent manifolds, which will only be deleted when the two objects
-	//   fail a narrowphase check. This means the manifolds can be quite busy, with lots of
-	//   new contacts per frame, but to solve any convex manifold in 3D you really only need
-	//   3 contacts (4 max), so tldr; perhaps you want persistent manifolds.. perhaps
-	//   you want to put some code here to sort contact points.. perhaps this comment is even 
-	//   more pointless than a passthrough function.. perhaps I should just stop typ
+	return drop;
+}
+
+void Manifold::WarmStart(SolverBodies& bodies)
+{
+	for (unsigned int i = 0; i < numContacts; ++i)
+	{
+		const ContactPoint& c = contactPoints[i];
+
+		//The accumulated impulses are stored before dividing by the constraint mass, the same as in SolveContactPoint
+		Vector3 impulse = Vector3(0.0f, 0.0f, 0.0f);
+
+		if (c.sumImpulseContact > 0.0f)
+		{
+			float constraintMass = bodies.ComputeConstraintMass(bodyA, bodyB, c.relPosA, c.relPosB, c.colNormal);
+			if (constraintMass > 0.0f)
+			{
+				impulse = impulse + c.colNormal * (c.sumImpulseContact / constraintMass);
+			}
+		}
+
+		float frictionLen = c.sumImpulseFriction.Length();
+		if (frictionLen > 1e-6f)
+		{
+			float frictionalMass = bodies.ComputeConstraintMass(bodyA, bodyB, c.relPosA, c.relPosB, c.sumImpulseFriction / frictionLen);
+			if (frictionalMass > 0.0f)
+			{
+				impulse = impulse + c.sumImpulseFriction / frictionalMass;
+			}
+		}
+
+		bodies.ApplyImpulse(bodyA, -impulse, c.relPosA);
+		bodies.ApplyImpulse(bodyB, impulse, c.relPosB);
+	}
 }
 
 void Manifold::DebugDraw() const
 {
-	if (contactPoints.size() > 0)
+	if (numContacts > 0)
 	{
 		//Loop around all contact points and draw them all as a line-loop
-		Vector3 globalOnA1 = pnodeA->GetPosition() + contactPoints.back().relPosA;
-		for (const ContactPoint& contact : contactPoints)
+		Vector3 globalOnA1 = pnodeA->GetPosition() + contactPoints[numContacts - 1].relPosA;
+		for (unsigned int i = 0; i < numContacts; ++i)
 		{
+			const ContactPoint& contact = contactPoints[i];
 			Vector3 globalOnA2 = pnodeA->GetPosition() + contact.relPosA;
 			Vector3 globalOnB = pnodeB->GetPosition() + contact.relPosB;
 
@@ -19,7 +19,12 @@ additional energy to the system (elasticity) or negate existing velocity (fricti
 #pragma once
 
 #include "PhysicsNode.h"
-#include <nclgl\Vector3.h>
+#include "SolverBodies.h"
+#include <nclgl/Vector3.h>
+
+#define MANIFOLD_MAX_CONTACTS 4		//Any more contacts are reduced down to the four that cover the largest area
+#define CONTACT_MATCH_DISTANCE 0.05f	//Max distance a contact can move between steps and still be treated as the same contact
+#define WARM_START_FACTOR 0.9f
 
 /* A contact constraint is actually the summation of a distance constraint to handle the main collision (normal)
 along with two friction constraints going along the axes perpendicular to the collision
@@ -54,15 +59,27 @@ public:
 	~Manifold();
 
 	//Initiate for collision pair
+	// - Manifolds are kept between steps while the pair is colliding, the previous step's contacts are
+	//   kept aside so new contacts can inherit their accumulated impulses
 	void Initiate(PhysicsNode* nodeA, PhysicsNode* nodeB);
 
+	//Forget the pair and its contacts before the manifold is reused for another pair, keeping the contact memory
+	void Reset();
+
 	//Called whenever a new collision contact between A & B are found
+	// - Once the manifold is full the contacts are reduced, always keeping the deepest contact and then whichever
+	//   others enclose the largest area
 	void AddContact(const Vector3& globalOnA, const Vector3& globalOnB, const Vector3& _normal, const float& _penetration);
 
-	//Sequentially solves each contact constraint
-	void ApplyImpulse();
+	//Sequentially solves each contact constraint on the solver's copy of the velocities
+	// - Returns the largest change in relative velocity applied to any contact
+	float ApplyImpulse(SolverBodies& bodies);
 	void PreSolverStep(float dt);
 
+	//Applies the impulses carried over from last step, so the solver starts close to the final solution
+	// - Must be called after PreSolverStep on every manifold, as the elasticity terms use the velocities before warm starting
+	void WarmStart(SolverBodies& bodies);
+
 
 	//Debug draws the manifold surface area
 	void DebugDraw() const;
@@ -71,12 +88,29 @@ public:
 	PhysicsNode* NodeA() { return pnodeA; }
 	PhysicsNode* NodeB() { return pnodeB; }
 
+	inline unsigned int GetNumContacts() const { return numContacts; }
+
 protected:
-	void SolveContactPoint(ContactPoint& c);
+	float SolveContactPoint(SolverBodies& bodies, ContactPoint& c);
 	void UpdateConstraint(ContactPoint& c);
 
+	//Picks which contact to replace with the new one when the manifold is full, or returns MANIFOLD_MAX_CONTACTS
+	// to drop the new contact instead
+	unsigned int PickContactToReplace(const ContactPoint& contact) const;
+
 public:
 	PhysicsNode*				pnodeA;
 	PhysicsNode*				pnodeB;
-	std::vector<ContactPoint>	contactPoints;
+
+protected:
+	//Contacts are stored inline, so manifolds never allocate
+	ContactPoint				contactPoints[MANIFOLD_MAX_CONTACTS];
+	unsigned int				numContacts;
+	ContactPoint				oldContactPoints[MANIFOLD_MAX_CONTACTS];	//Contacts from the previous step
+	unsigned int				numOldContacts;
+
+	//Set in PreSolverStep so the solver doesn't have to go back to the physics nodes
+	unsigned int				bodyA;
+	unsigned int				bodyB;
+	float						frictionCoef;
 };
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "Octant.h"
+#include "Octree.h"
 #include "nclgl/NCLDebug.h"
+#include <algorithm>
 
 Octant::Octant()
 {
@@ -7,33 +9,59 @@ Octant::Octant()
 	m_parent = NULL;
 }
 
-Octant::Octant(const BoundingBox region, std::vector<PhysicsNode*>& pNodes, Octant* parent)
+Octant::~Octant()
+{
+	//Child octants belong to the octree's octant pool so aren't deleted here
+}
+
+void Octant::reset(Octree* tree, const BoundingBox& region, Octant* parent)
 {
+	m_tree = tree;
 	m_region = region;
-	m_physicsNodes = pNodes;
 	m_parent = parent;
+	m_octants = NULL;
+	m_physicsNodes.clear();
 }
 
-Octant::~Octant()
+void Octant::addObject(PhysicsNode* pNode, const BoundingBox& bounds)
 {
-	for (size_t i = 0; i < NUM_OCTANTS; ++i)
+	//Not a leaf so pass the node down to every child octant it overlaps
+	if (!isLeaf())
 	{
-		SAFE_DELETE(m_octants[i])
+		for (int i = 0; i < NUM_OCTANTS; ++i)
+		{
+			if (m_octants[i].m_region.Intersects(bounds))
+			{
+				m_octants[i].addObject(pNode, bounds);
+			}
+		}
+		return;
 	}
+
+	m_physicsNodes.push_back(pNode);
+	m_tree->m_proxies[pNode].octants.push_back(this);
+
+	//Split the octant if it is now too full
+	divideOctant();
 }
 
-void Octant::updateObjects(std::vector<PhysicsNode*>& pNodes)
+void Octant::removeObject(PhysicsNode* pNode)
 {
-	m_physicsNodes = pNodes;
+	//Swap and pop as the order of the nodes doesn't matter
+	auto found = std::find(m_physicsNodes.begin(), m_physicsNodes.end(), pNode);
+	if (found != m_physicsNodes.end())
+	{
+		*found = m_physicsNodes.back();
+		m_physicsNodes.pop_back();
+	}
 }
 
 void Octant::divideOctant()
 {
-	//Reset the octants before dividing
-	for (int i = 0; i < NUM_OCTANTS; ++i)
+	//Only leaf octants can be divided
+	if (!isLeaf())
 	{
-		delete m_octants[i];
-		m_octants[i] = NULL;
+		return;
 	}
 
 	//Only continue if the octree contains more than the maximum number of objects
@@ -61,10 +89,27 @@ void Octant::divideOctant()
 
 	Vector3 halfDims = dimensions * 0.5f;
 	Vector3 centre = m_region._min + halfDims;
-	//Divide the octree into its 8 octants
-	BoundingBox regions[NUM_OCTANTS] = { BoundingBox() };
-	std::vector<PhysicsNode*> pNodeLists[NUM_OCTANTS];
 
+	//Only continue if at least one node is small enough to fit inside a child octant, otherwise
+	//dividing wouldn't separate anything and each node would just be copied into several children
+	bool canSeparate = false;
+	for (PhysicsNode* pNode : m_physicsNodes)
+	{
+		const BoundingBox& bounds = m_tree->m_proxies[pNode].looseBounds;
+		Vector3 size = bounds._max - bounds._min;
+		if (size.x <= halfDims.x && size.y <= halfDims.y && size.z <= halfDims.z)
+		{
+			canSeparate = true;
+			break;
+		}
+	}
+	if (!canSeparate)
+	{
+		return;
+	}
+
+	//Divide the octant into its 8 child octants
+	m_octants = m_tree->allocOctants();
 	for (int i = 0; i < NUM_OCTANTS; ++i)
 	{
 		//Bitwise AND used to determine octant centres within the for loop
@@ -73,42 +118,105 @@ void Octant::divideOctant()
 		newCentre.y += halfDims.y * (i & 2 ? 0.5f : -0.5f);			//True for i = 2, 3, 6, 7
 		newCentre.z += halfDims.z * (i & 1 ? 0.5f : -0.5f);			//True for i = 1, 3, 5, 7
 
-		regions[i]._min = newCentre - halfDims * 0.5f;
-		regions[i]._max = newCentre + halfDims * 0.5f;
+		BoundingBox region;
+		region._min = newCentre - halfDims * 0.5f;
+		region._max = newCentre + halfDims * 0.5f;
+		m_octants[i].reset(m_tree, region, this);
+	}
+
+	//Move the physics nodes into each child octant that overlaps their loose bounds
+	//Child octants that end up too full will be recursively divided
+	for (PhysicsNode* pNode : m_physicsNodes)
+	{
+		OctreeProxy& proxy = m_tree->m_proxies[pNode];
+		proxy.octants.erase(std::find(proxy.octants.begin(), proxy.octants.end(), this));
 
-		//Add the physicsNodes to each new octant if any point on the node's bounding radius is inside the octant
-		for (PhysicsNode* pNode : m_physicsNodes)
+		for (int i = 0; i < NUM_OCTANTS; ++i)
 		{
-			if (pNode->GetPosition().x + pNode->GetBoundingRadius() > regions[i]._min.x &&
-				pNode->GetPosition().x - pNode->GetBoundingRadius() < regions[i]._max.x &&
-				pNode->GetPosition().y + pNode->GetBoundingRadius() > regions[i]._min.y &&
-				pNode->GetPosition().y - pNode->GetBoundingRadius() < regions[i]._max.y &&
-				pNode->GetPosition().z + pNode->GetBoundingRadius() > regions[i]._min.z &&
-				pNode->GetPosition().z - pNode->GetBoundingRadius() < regions[i]._max.z)
+			if (m_octants[i].m_region.Intersects(proxy.looseBounds))
 			{
-				//Add node to this octant's list
-				pNodeLists[i].push_back(pNode);
+				m_octants[i].addObject(pNode, proxy.looseBounds);
 			}
 		}
-
-		m_octants[i] = new Octant(regions[i], pNodeLists[i], this);
-
-		//Recursively divide each sub octant where required
-		m_octants[i]->divideOctant();
 	}
-	
+
 	//Remove all the nodes from this octant because they've all been added to child octants
 	m_physicsNodes.clear();
 }
 
+void Octant::mergeOctant()
+{
+	if (isLeaf())
+	{
+		return;
+	}
+
+	//Move the physics nodes from the child octants back into this octant
+	for (int i = 0; i < NUM_OCTANTS; ++i)
+	{
+		for (PhysicsNode* pNode : m_octants[i].m_physicsNodes)
+		{
+			OctreeProxy& proxy = m_tree->m_proxies[pNode];
+			proxy.octants.erase(std::find(proxy.octants.begin(), proxy.octants.end(), &m_octants[i]));
+
+			//A node can overlap several children but must only be added once
+			if (std::find(m_physicsNodes.begin(), m_physicsNodes.end(), pNode) == m_physicsNodes.end())
+			{
+				m_physicsNodes.push_back(pNode);
+				proxy.octants.push_back(this);
+			}
+		}
+	}
+
+	//Return the children to the octant pool
+	m_tree->freeOctants(m_octants);
+	m_octants = NULL;
+}
+
+bool Octant::canMerge() const
+{
+	if (isLeaf())
+	{
+		return false;
+	}
+
+	//Count the unique nodes in the children, which must all be leaves
+	PhysicsNode* uniqueNodes[MERGE_OBJECTS];
+	int numUnique = 0;
+	for (int i = 0; i < NUM_OCTANTS; ++i)
+	{
+		if (!m_octants[i].isLeaf())
+		{
+			return false;
+		}
+
+		for (PhysicsNode* pNode : m_octants[i].m_physicsNodes)
+		{
+			if (std::find(uniqueNodes, uniqueNodes + numUnique, pNode) == uniqueNodes + numUnique)
+			{
+				if (numUnique == MERGE_OBJECTS)
+				{
+					return false;
+				}
+				uniqueNodes[numUnique++] = pNode;
+			}
+		}
+	}
+
+	return true;
+}
+
 void Octant::genPairs(std::vector<CollisionPair>& colPairs)
 {
 	//if this is a leaf so generate pairs
-	if (m_physicsNodes.size() > 0)
+	if (isLeaf())
 	{
-		PhysicsNode *pnodeA, *pnodeB;
+		if (m_physicsNodes.size() < 2)
+		{
+			return;
+		}
 
-		std::vector<PhysicsNode*> rootNodes = getRoot()->getPhysicsNodes();
+		PhysicsNode *pnodeA, *pnodeB;
 
 		//Calculate octree collision pairs
 		for (size_t i = 0; i < m_physicsNodes.size() - 1; ++i)
@@ -118,43 +226,14 @@ void Octant::genPairs(std::vector<CollisionPair>& colPairs)
 				pnodeA = m_physicsNodes[i];
 				pnodeB = m_physicsNodes[j];
 
-				//if both objects are at rest then there is no need to check for collision
-				if (pnodeA->GetAtRest() && pnodeB->GetAtRest())
-				{
-					continue;
-				}
-
-				//if both nodes have the same soft body id then don't check collision
-				if (pnodeA->GetSoftBodyID() == pnodeB->GetSoftBodyID() && pnodeA->GetSoftBodyID() != NULL)
-				{
-					continue;
-				}
-
-				//pnodeA->SetTimeSinceRestCheck()
-
-				//Check they both atleast have collision shapes
-				if (pnodeA->GetCollisionShape() != NULL
-					&& pnodeB->GetCollisionShape() != NULL)
+				//Only add if this pair hasn't been added previously
+				if (IsBroadphasePair(pnodeA, pnodeB)
+					&& m_tree->m_pairSet.Insert(PairHashSet::PairKey(pnodeA, pnodeB)))
 				{
 					CollisionPair cp;
 					cp.pObjectA = pnodeA;
 					cp.pObjectB = pnodeB;
-
-					bool pairFound = false;
-
-					//Only add if this pair hasn't been added previously
-					for (CollisionPair cp2 : colPairs)
-					{
-						if (cp == cp2)
-						{
-							pairFound = true;
-							continue;
-						}
-					}
-					if (!pairFound)
-					{
-						colPairs.push_back(cp);
-					}
+					colPairs.push_back(cp);
 				}
 			}
 		}
@@ -164,10 +243,7 @@ void Octant::genPairs(std::vector<CollisionPair>& colPairs)
 	{
 		for (size_t i = 0; i < NUM_OCTANTS; ++i)
 		{
-			if (m_octants[i])
-			{
-				m_octants[i]->genPairs(colPairs);
-			}
+			m_octants[i].genPairs(colPairs);
 		}
 	}
 }
@@ -210,11 +286,11 @@ void Octant::debugDraw()
 	NCLDebug::DrawThickLine(corner, Vector3(corner.x,			m_region._min.y,	corner.z		), lineThickness, Vector4(0.0f, 1.0f, 0.0f, 1.0f));
 	NCLDebug::DrawThickLine(corner, Vector3(corner.x,			corner.y,			m_region._min.z	), lineThickness, Vector4(0.0f, 0.0f, 1.0f, 1.0f));
 
-	for (int i = 0; i < NUM_OCTANTS; ++i)
+	if (!isLeaf())
 	{
-		if (m_octants[i])
+		for (int i = 0; i < NUM_OCTANTS; ++i)
 		{
-			m_octants[i]->debugDraw();
+			m_octants[i].debugDraw();
 		}
 	}
 }
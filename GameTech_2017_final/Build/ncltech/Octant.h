@@ -9,18 +9,28 @@
 #define NUM_OCTANTS 8		//Number of child octants
 #define MIN_SIZE 1			//Minumum dimensions for an octant
 #define MAX_OBJECTS 5		//Maximum number of physics objects that can occupy an octant
+#define MERGE_OBJECTS 3		//Children are merged back into their parent once they contain this many objects or fewer
+
+class Octree;
 
 class Octant
 {
+	friend class Octree;
 public:
 	Octant();
-	Octant(BoundingBox region, std::vector<PhysicsNode*>& pNodes, Octant* parent = NULL);
 	~Octant();
 
-	//Update the nodes 
-	void updateObjects(std::vector<PhysicsNode*>& pNodes);
+	//Reset the octant so it can be reused by the octree's octant pool
+	void reset(Octree* tree, const BoundingBox& region, Octant* parent);
+
+	//Add/remove a physics node from this leaf octant
+	// - Adding may split the octant if it now contains more than MAX_OBJECTS
+	// - Removing may merge the parent octant if its children are now mostly empty
+	void addObject(PhysicsNode* pNode, const BoundingBox& bounds);
+	void removeObject(PhysicsNode* pNode);
 
 	void divideOctant();
+	void mergeOctant();
 
 	void genPairs(std::vector<CollisionPair>& colPairs);
 
@@ -29,12 +39,17 @@ public:
 
 	Octant* getRoot();
 
-	//inline void setPhysicsNodes(const std::vector<PhysicsNode> pNodes) { m_physicsNodes = pNodes; }
-	inline std::vector<PhysicsNode*> getPhysicsNodes() const { return m_physicsNodes; }
+	inline bool isLeaf() const { return m_octants == NULL; }
+	inline const BoundingBox& getRegion() const { return m_region; }
+	inline const std::vector<PhysicsNode*>& getPhysicsNodes() const { return m_physicsNodes; }
 
 private:
+	//Returns true if there are few enough objects in the child octants for them to be merged into this one
+	bool canMerge() const;
+
+	Octree* m_tree = NULL;							//The octree that owns this octant and its octant pool
 	BoundingBox m_region;							//The OctTree's bounding region
-	std::vector<PhysicsNode*> m_physicsNodes;		//The physics objects contained within the OctTree
+	std::vector<PhysicsNode*> m_physicsNodes;		//The physics objects contained within the OctTree (leaf octants only)
 	Octant* m_parent = NULL;
-	Octant* m_octants[NUM_OCTANTS] = { NULL };		//8 children
-};
\ No newline at end of file
+	Octant* m_octants = NULL;						//8 children, allocated together as a single block from the octant pool
+};
@@ -1,36 +1,208 @@
 #include "Octree.h"
+#include <algorithm>
 
 Octree::Octree()
 {
 	m_root = new Octant();
+	m_root->reset(this, BoundingBox(), NULL);
 }
 
 Octree::Octree(BoundingBox region, std::vector<PhysicsNode*>& pNodes)
 {
-	m_root = new Octant(region, pNodes, NULL);
+	m_root = new Octant();
+	m_root->reset(this, region, NULL);
+
+	for (PhysicsNode* pNode : pNodes)
+	{
+		insertObject(pNode);
+	}
 }
 
 Octree::~Octree()
 {
 	SAFE_DELETE(m_root)
+
+	for (Octant* octants : m_octantBlocks)
+	{
+		delete[] octants;
+	}
+	m_octantBlocks.clear();
+	m_freeOctantBlocks.clear();
+}
+
+void Octree::insertObject(PhysicsNode* pNode)
+{
+	//Already in the tree
+	if (m_proxies.find(pNode) != m_proxies.end())
+	{
+		return;
+	}
+
+	insertProxy(pNode, m_proxies[pNode]);
 }
 
-void Octree::updateObjects(std::vector<PhysicsNode*>& pNodes)
+void Octree::removeObject(PhysicsNode* pNode)
 {
-	m_pNodes = pNodes;
+	auto found = m_proxies.find(pNode);
+	if (found != m_proxies.end())
+	{
+		removeProxy(pNode, found->second);
+		m_proxies.erase(found);
+	}
 }
 
-void Octree::buildOctree()
+void Octree::clear()
 {
-	//Update the physics nodes in the root octant
-	m_root->updateObjects(m_pNodes);
-	//Divide the root octant into 8 octants and split the physics nodes between these octants based on their position
-	//These octants will then continue to be recursively divided until each octant contains a maximum 
-	//number of physics nodes
-	m_root->divideOctant();
+	//Return every child octant to the pool
+	m_freeOctantBlocks = m_octantBlocks;
+	for (Octant* octants : m_octantBlocks)
+	{
+		for (int i = 0; i < NUM_OCTANTS; ++i)
+		{
+			octants[i].m_octants = NULL;
+			octants[i].m_physicsNodes.clear();
+		}
+	}
+
+	m_root->reset(this, m_root->getRegion(), NULL);
+	m_proxies.clear();
+	m_outside.clear();
+}
+
+void Octree::updateObjects()
+{
+	m_numReinserted = 0;
+
+	//Only the nodes that have moved outside of their loose bounds need to be reinserted
+	for (auto& itr : m_proxies)
+	{
+		if (!itr.second.looseBounds.Contains(itr.first->GetWorldSpaceAABB()))
+		{
+			removeProxy(itr.first, itr.second);
+			insertProxy(itr.first, itr.second);
+			++m_numReinserted;
+		}
+	}
+}
+
+void Octree::genPairs(std::vector<CollisionPair>& colPairs)
+{
+	//Nodes straddling octant boundaries are in several leaves, so the same pair
+	//can be found more than once. The pair set is used to only add it once.
+	m_pairSet.Clear();
+	m_pairSet.Reserve(colPairs.capacity());
+	m_root->genPairs(colPairs);
+
+	//Nodes outside of the octree's region are checked against every other node
+	//These are never in a leaf octant so the pairs can't already have been generated
+	for (PhysicsNode* pnodeA : m_outside)
+	{
+		for (auto& itr : m_proxies)
+		{
+			PhysicsNode* pnodeB = itr.first;
+
+			//Only generate pairs between two outside nodes once
+			if (pnodeA == pnodeB || (itr.second.outside && pnodeB < pnodeA))
+			{
+				continue;
+			}
+
+			if (IsBroadphasePair(pnodeA, pnodeB))
+			{
+				CollisionPair cp;
+				cp.pObjectA = pnodeA;
+				cp.pObjectB = pnodeB;
+				colPairs.push_back(cp);
+			}
+		}
+	}
 }
 
 void Octree::debugDraw()
 {
 	m_root->debugDraw();
 }
+
+BoundingBox Octree::getLooseBounds(const PhysicsNode* pNode)
+{
+	const BoundingBox& bounds = pNode->GetWorldSpaceAABB();
+	const Vector3 looseness(OCTREE_LOOSENESS, OCTREE_LOOSENESS, OCTREE_LOOSENESS);
+	return BoundingBox(bounds._min - looseness, bounds._max + looseness);
+}
+
+void Octree::insertProxy(PhysicsNode* pNode, OctreeProxy& proxy)
+{
+	proxy.looseBounds = getLooseBounds(pNode);
+	proxy.octants.clear();
+	proxy.outside = !m_root->getRegion().Contains(proxy.looseBounds);
+
+	if (proxy.outside)
+	{
+		m_outside.push_back(pNode);
+	}
+	else
+	{
+		m_root->addObject(pNode, proxy.looseBounds);
+	}
+}
+
+void Octree::removeProxy(PhysicsNode* pNode, OctreeProxy& proxy)
+{
+	if (proxy.outside)
+	{
+		m_outside.erase(std::find(m_outside.begin(), m_outside.end(), pNode));
+		proxy.outside = false;
+		return;
+	}
+
+	//Remove the node from all of its leaves before merging anything, otherwise a merge could pull
+	//the node back up into a parent from a leaf it hasn't been removed from yet
+	m_mergeParents.clear();
+	for (Octant* octant : proxy.octants)
+	{
+		octant->removeObject(pNode);
+		if (octant->m_parent && std::find(m_mergeParents.begin(), m_mergeParents.end(), octant->m_parent) == m_mergeParents.end())
+		{
+			m_mergeParents.push_back(octant->m_parent);
+		}
+	}
+	proxy.octants.clear();
+
+	//Merge any octants that are now mostly empty, working up the tree
+	for (Octant* octant : m_mergeParents)
+	{
+		while (octant && octant->canMerge())
+		{
+			octant->mergeOctant();
+			octant = octant->m_parent;
+		}
+	}
+}
+
+Octant* Octree::allocOctants()
+{
+	if (!m_freeOctantBlocks.empty())
+	{
+		Octant* octants = m_freeOctantBlocks.back();
+		m_freeOctantBlocks.pop_back();
+		return octants;
+	}
+
+	Octant* octants = new Octant[NUM_OCTANTS];
+	m_octantBlocks.push_back(octants);
+	return octants;
+}
+
+void Octree::freeOctants(Octant* octants)
+{
+	for (int i = 0; i < NUM_OCTANTS; ++i)
+	{
+		if (!octants[i].isLeaf())
+		{
+			freeOctants(octants[i].m_octants);
+		}
+		octants[i].m_octants = NULL;
+		octants[i].m_physicsNodes.clear();
+	}
+	m_freeOctantBlocks.push_back(octants);
+}
@@ -1,29 +1,74 @@
 #pragma once
 
 #include "Octant.h"
+#include "PairHashSet.h"
+#include <unordered_map>
 
 //Octree class to manage the world's octants
 //The octree contains a single octant which can be split into another 8 octants as required
+//
+//The octree is persistent between physics updates. Each physics node is stored in every leaf octant
+//that overlaps its 'loose' bounds - its bounding radius expanded by OCTREE_LOOSENESS. As long as the
+//node stays inside its loose bounds it doesn't need to be touched, so only the nodes that have moved
+//far enough are removed and reinserted each update. Octants are split and merged as nodes move in and
+//out of them, and all child octants are kept in a pool so they are never reallocated.
+
+#define OCTREE_LOOSENESS 0.1f		//Distance the loose bounds extend past a node's bounding radius
+
+//Per physics node data kept by the octree
+struct OctreeProxy
+{
+	BoundingBox				looseBounds;		//The bounds the node was last inserted with
+	std::vector<Octant*>	octants;			//All of the leaf octants containing the node
+	bool					outside = false;	//The node isn't fully inside the octree's region
+};
 
 class Octree
 {
+	friend class Octant;
 public:
 	Octree();
 	Octree(BoundingBox region, std::vector<PhysicsNode*>& pNodes);
 	~Octree();
 
-	void updateObjects(std::vector<PhysicsNode*>& pNodes);
+	//Add/remove a single node
+	void insertObject(PhysicsNode* pNode);
+	void removeObject(PhysicsNode* pNode);
+	void clear();
+
+	//Reinsert any nodes that have moved outside of their loose bounds
+	void updateObjects();
 
-	void buildOctree();
+	//Generate all the potentially colliding pairs
+	void genPairs(std::vector<CollisionPair>& colPairs);
 
 	void debugDraw();
 
 	Octant* getRoot() { return m_root; }
 
-	//inline void setPhysicsNodes(const std::vector<PhysicsNode> pNodes) { m_physicsNodes = pNodes; }
-	//inline std::vector<PhysicsNode> getPhysicsNodes() const { return m_physicsNodes; }
+	//Number of nodes reinserted during the last update
+	inline int getNumReinserted() const { return m_numReinserted; }
 
 private:
-	Octant* m_root = NULL;							//The octree contains a single root octant
-	std::vector<PhysicsNode*> m_pNodes = { NULL };	//All of the physics nodes in the tree that need to be put into octants
+	//Cached world space AABB of the node expanded by the looseness
+	static BoundingBox getLooseBounds(const PhysicsNode* pNode);
+
+	void insertProxy(PhysicsNode* pNode, OctreeProxy& proxy);
+	void removeProxy(PhysicsNode* pNode, OctreeProxy& proxy);
+
+	//Octant pool - octants are always allocated 8 at a time as a set of children
+	Octant* allocOctants();
+	void freeOctants(Octant* octants);
+
+	Octant* m_root = NULL;										//The octree contains a single root octant
+	std::unordered_map<PhysicsNode*, OctreeProxy> m_proxies;	//All of the physics nodes in the tree
+	std::vector<PhysicsNode*> m_outside;						//Nodes that are not fully inside the root region
+
+	std::vector<Octant*> m_octantBlocks;						//Every block of 8 octants ever allocated
+	std::vector<Octant*> m_freeOctantBlocks;					//Blocks of 8 octants not currently in use
+	std::vector<Octant*> m_mergeParents;						//Scratch list for removeProxy, kept to avoid reallocating
+
+	PairHashSet m_pairSet;										//Pairs generated so far this update, to skip duplicates
+
+	int m_numReinserted = 0;
 };
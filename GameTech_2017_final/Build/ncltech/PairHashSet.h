@@ -0,0 +1,117 @@
+#pragma once
+
+#include "PhysicsNode.h"
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+//Open addressing (linear probing) hash set of collision pair keys
+//Used by the broadphase to reject duplicate pairs in constant time
+//
+//A pair key is built from the physics IDs of the two nodes, smallest ID first, so the same two nodes
+//always give the same 64 bit key whichever order they are found in. Physics IDs start at 1 so a key
+//of 0 marks an empty slot. The table never shrinks so once it has grown clearing it and inserting
+//doesn't allocate.
+class PairHashSet
+{
+public:
+	PairHashSet() : numKeys(0), mask(0) {}
+
+	//Order independent key for the pair of nodes
+	static inline uint64_t PairKey(const PhysicsNode* pnodeA, const PhysicsNode* pnodeB)
+	{
+		uint64_t idA = pnodeA->GetPhysicsID();
+		uint64_t idB = pnodeB->GetPhysicsID();
+		return idA < idB ? (idA << 32) | idB : (idB << 32) | idA;
+	}
+
+	//Remove all keys, keeping the table's memory
+	void Clear()
+	{
+		if (numKeys > 0)
+		{
+			std::fill(table.begin(), table.end(), 0);
+			numKeys = 0;
+		}
+	}
+
+	//Make sure the table can hold the given number of keys without growing
+	void Reserve(size_t count)
+	{
+		if (count * 2 > table.size())
+		{
+			Rehash(count * 2);
+		}
+	}
+
+	//Add the key to the set
+	//Returns false if the key was already in the set
+	bool Insert(uint64_t key)
+	{
+		//Keep the load factor at or below 0.5 so probe sequences stay short
+		if ((numKeys + 1) * 2 > table.size())
+		{
+			Rehash((numKeys + 1) * 2);
+		}
+
+		size_t slot = Hash(key) & mask;
+		while (table[slot] != 0)
+		{
+			if (table[slot] == key)
+			{
+				return false;
+			}
+			slot = (slot + 1) & mask;
+		}
+
+		table[slot] = key;
+		++numKeys;
+		return true;
+	}
+
+	inline size_t Size() const { return numKeys; }
+
+protected:
+	//64 bit finaliser from MurmurHash3 to spread the IDs over the whole table
+	static inline uint64_t Hash(uint64_t key)
+	{
+		key ^= key >> 33;
+		key *= 0xff51afd7ed558ccdULL;
+		key ^= key >> 33;
+		key *= 0xc4ceb9fe1a85ec53ULL;
+		key ^= key >> 33;
+		return key;
+	}
+
+	//Grow the table to the next power of two above minSize and reinsert the existing keys
+	void Rehash(size_t minSize)
+	{
+		size_t newSize = 64;
+		while (newSize < minSize)
+		{
+			newSize <<= 1;
+		}
+
+		std::vector<uint64_t> oldTable;
+		oldTable.swap(table);
+		table.assign(newSize, 0);
+		mask = newSize - 1;
+
+		for (uint64_t key : oldTable)
+		{
+			if (key != 0)
+			{
+				size_t slot = Hash(key) & mask;
+				while (table[slot] != 0)
+				{
+					slot = (slot + 1) & mask;
+				}
+				table[slot] = key;
+			}
+		}
+	}
+
+	std::vector<uint64_t>	table;
+	size_t					numKeys;
+	size_t					mask;
+};
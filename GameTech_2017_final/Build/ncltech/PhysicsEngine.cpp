@@ -1,10 +1,11 @@
 #include "PhysicsEngine.h"
-#include "GameObject.h"
+#include <ncltech/GameObject.h>		//Not "GameObject.h", so headless builds can swap in one without the graphics pipeline
 #include "CollisionDetectionSAT.h"
-#include <nclgl\NCLDebug.h>
-#include <nclgl\Window.h>
+#include "CollisionDispatch.h"
+#include <nclgl/NCLDebug.h>
 #include <omp.h>
 #include <algorithm>
+#include <xmmintrin.h>
 
 
 
@@ -15,26 +16,54 @@ void PhysicsEngine::SetDefaults()
 	updateRealTimeAccum = 0.0f;
 	gravity = Vector3(0.0f, -9.81f, 0.0f);
 	dampingFactor = 0.999f;
+	solverMinIterations = SOLVER_MIN_ITERATIONS;
+	solverMaxIterations = SOLVER_MAX_ITERATIONS;
+	solverTolerance = SOLVER_TOLERANCE;
 }
 
-void PhysicsEngine::ToggleOctrees()
+void PhysicsEngine::SetBroadphaseMode(BroadphaseMode mode)
 {
-	useOctrees = !useOctrees;
-	if (!useOctrees)
+	if (mode == broadphaseMode)
 	{
-		delete m_octree;
-		m_octree = NULL;
+		return;
 	}
-	else
+
+	SAFE_DELETE(m_octree);
+	SAFE_DELETE(m_sortAndSweep);
+	SAFE_DELETE(m_aabbTree);
+	SAFE_DELETE(m_uniformGrid);
+
+	broadphaseMode = mode;
+	switch (broadphaseMode)
 	{
+	case BROADPHASE_OCTREE:
 		CreateOctree();
+		break;
+	case BROADPHASE_SORTANDSWEEP:
+		m_sortAndSweep = new SortAndSweep(physicsNodes);
+		break;
+	case BROADPHASE_AABBTREE:
+		m_aabbTree = new DynamicAABBTree(physicsNodes);
+		break;
+	case BROADPHASE_UNIFORMGRID:
+		m_uniformGrid = new UniformGrid(physicsNodes);
+		break;
+	default:
+		break;
 	}
 }
 
+void PhysicsEngine::ToggleOctrees()
+{
+	SetBroadphaseMode(UsingOctrees() ? BROADPHASE_BRUTEFORCE : BROADPHASE_OCTREE);
+}
+
 PhysicsEngine::PhysicsEngine()
 {
 	//Variables set here will /not/ be reset with each scene
 	isPaused = false;  
+	physicsThreadRunning = false;
+	physicsThreadBehind = false;
 	//debugDrawFlags = DEBUGDRAW_FLAGS_CONSTRAINT;
 
 	CreateOctree();
@@ -43,17 +72,75 @@ PhysicsEngine::PhysicsEngine()
 
 PhysicsEngine::~PhysicsEngine()
 {
+	SetThreaded(false);
 	RemoveAllPhysicsObjects();
+
+	for (Manifold* m : freeManifolds)
+	{
+		delete m;
+	}
+	freeManifolds.clear();
+
+	for (FrameArena* arena : threadArenas)
+	{
+		delete arena;
+	}
+	threadArenas.clear();
 	SAFE_DELETE(m_octree);
+	SAFE_DELETE(m_sortAndSweep);
+	SAFE_DELETE(m_aabbTree);
+	SAFE_DELETE(m_uniformGrid);
 }
 
 void PhysicsEngine::AddPhysicsObject(PhysicsNode* obj)
 {
+	if (inPhysicsUpdate)
+	{
+		pendingAdditions.push_back(obj);
+		return;
+	}
+
+	obj->SetPhysicsID(nextPhysicsID++);
+	obj->ResetPublishedTransform();
 	physicsNodes.push_back(obj);
+
+	if (m_octree)
+	{
+		m_octree->insertObject(obj);
+	}
+
+	if (m_sortAndSweep)
+	{
+		m_sortAndSweep->InsertObject(obj);
+	}
+
+	if (m_aabbTree)
+	{
+		m_aabbTree->InsertObject(obj);
+	}
+
+	if (m_uniformGrid)
+	{
+		m_uniformGrid->InsertObject(obj);
+	}
 }
 
 void PhysicsEngine::RemovePhysicsObject(PhysicsNode* obj)
 {
+	if (inPhysicsUpdate)
+	{
+		auto pending = std::find(pendingAdditions.begin(), pendingAdditions.end(), obj);
+		if (pending != pendingAdditions.end())
+		{
+			pendingAdditions.erase(pending);
+		}
+		else
+		{
+			pendingRemovals.push_back(obj);
+		}
+		return;
+	}
+
 	//Lookup the object in question
 	auto found_loc = std::find(physicsNodes.begin(), physicsNodes.end(), obj);
 
@@ -61,7 +148,84 @@ void PhysicsEngine::RemovePhysicsObject(PhysicsNode* obj)
 	if (found_loc != physicsNodes.end())
 	{
 		physicsNodes.erase(found_loc);
+
+		//Forget any pairs involving the object, waking anything it was resting against so nothing is left
+		// asleep in mid air
+		std::vector<CollisionPair> separatedPairs;
+		for (auto itr = pairCache.begin(); itr != pairCache.end();)
+		{
+			CachedPair& pair = itr->second;
+			if (pair.nodeA == obj || pair.nodeB == obj)
+			{
+				PhysicsNode* other = (pair.nodeA == obj) ? pair.nodeB : pair.nodeA;
+				if (pair.manifold)
+				{
+					other->WakeUp();
+
+					manifolds.erase(std::remove(manifolds.begin(), manifolds.end(), pair.manifold), manifolds.end());
+					FreeManifold(pair.manifold);
+				}
+
+				CollisionPair cp;
+				cp.pObjectA = other;
+				cp.pObjectB = obj;
+				separatedPairs.push_back(cp);
+				itr = pairCache.erase(itr);
+			}
+			else
+			{
+				++itr;
+			}
+		}
+
+		if (m_octree)
+		{
+			m_octree->removeObject(obj);
+		}
+
+		if (m_sortAndSweep)
+		{
+			m_sortAndSweep->RemoveObject(obj);
+		}
+
+		if (m_aabbTree)
+		{
+			m_aabbTree->RemoveObject(obj);
+		}
+
+		if (m_uniformGrid)
+		{
+			m_uniformGrid->RemoveObject(obj);
+		}
+
+		//Only the objects left behind are told they have stopped touching it
+		// - The object is fully removed by now, so the callbacks can remove more objects
+		for (const CollisionPair& cp : separatedPairs)
+		{
+			cp.pObjectA->FireOnCollisionExitEvent(cp.pObjectA, cp.pObjectB);
+		}
+	}
+}
+
+void PhysicsEngine::DeletePhysicsObject(PhysicsNode* obj)
+{
+	if (inPhysicsUpdate)
+	{
+		//The rest of the step can still reach the node, so make sure it can't call back into its owner
+		obj->SetParent(NULL);
+		obj->SetOnCollisionCallback(nullptr);
+		obj->SetOnCollisionEnterCallback(nullptr);
+		obj->SetOnCollisionExitCallback(nullptr);
+		obj->SetOnUpdateCallback(nullptr);
+
+		pendingRemovals.erase(std::remove(pendingRemovals.begin(), pendingRemovals.end(), obj), pendingRemovals.end());
+		pendingAdditions.erase(std::remove(pendingAdditions.begin(), pendingAdditions.end(), obj), pendingAdditions.end());
+		pendingDeletions.push_back(obj);
+		return;
 	}
+
+	RemovePhysicsObject(obj);
+	delete obj;
 }
 
 void PhysicsEngine::RemoveAllPhysicsObjects()
@@ -72,12 +236,27 @@ void PhysicsEngine::RemoveAllPhysicsObjects()
 		delete c;
 	}
 	constraints.clear();
+	activeConstraints.clear();
 
-	for (Manifold* m : manifolds)
+	for (Cloth* cloth : cloths)
 	{
-		delete m;
+		delete cloth;
 	}
+	cloths.clear();
+
+	for (auto& itr : pairCache)
+	{
+		if (itr.second.manifold)
+		{
+			FreeManifold(itr.second.manifold);
+		}
+	}
+	pairCache.clear();
 	manifolds.clear();
+	pairAxisCache.clear();
+	pendingAdditions.clear();
+	pendingRemovals.clear();
+	pendingDeletions.clear();
 
 
 	//Delete and remove all physics objects
@@ -89,13 +268,163 @@ void PhysicsEngine::RemoveAllPhysicsObjects()
 		delete obj;
 	}
 	physicsNodes.clear();
+
+	if (m_octree)
+	{
+		m_octree->clear();
+	}
+
+	if (m_sortAndSweep)
+	{
+		m_sortAndSweep->Clear();
+	}
+
+	if (m_aabbTree)
+	{
+		m_aabbTree->Clear();
+	}
+
+	if (m_uniformGrid)
+	{
+		m_uniformGrid->Clear();
+	}
+}
+
+
+Manifold* PhysicsEngine::AllocManifold()
+{
+	Manifold* m = NULL;
+
+	//Called from the narrowphase threads
+#pragma omp critical(manifoldPool)
+	{
+		if (!freeManifolds.empty())
+		{
+			m = freeManifolds.back();
+			freeManifolds.pop_back();
+		}
+	}
+
+	return m ? m : new Manifold();
+}
+
+void PhysicsEngine::FreeManifold(Manifold* m)
+{
+	m->Reset();
+	freeManifolds.push_back(m);
+}
+
+void PhysicsEngine::SetThreaded(bool threaded)
+{
+	if (threaded == isThreaded)
+	{
+		return;
+	}
+
+	if (threaded)
+	{
+		//Start interpolating from where everything is now
+		for (PhysicsNode* pnode : physicsNodes)
+		{
+			pnode->ResetPublishedTransform();
+		}
+		lastStepTime = std::chrono::steady_clock::now();
+		physicsThreadBehind = false;
+
+		isThreaded = true;
+		physicsThreadRunning = true;
+		physicsThread = std::thread(&PhysicsEngine::PhysicsThreadLoop, this);
+	}
+	else
+	{
+		physicsThreadRunning = false;
+		physicsThread.join();
+		isThreaded = false;
+		updateRealTimeAccum = 0.0f;
+
+		//Snap everything to its latest state, as Update() won't be interpolating it any more
+		for (PhysicsNode* pnode : physicsNodes)
+		{
+			pnode->FireOnUpdateCallback();
+		}
+
+		for (Cloth* cloth : cloths)
+		{
+			cloth->FireOnUpdateCallback();
+		}
+	}
 }
 
+void PhysicsEngine::PhysicsThreadLoop()
+{
+	using namespace std::chrono;
+
+	steady_clock::time_point nextStep = steady_clock::now();
+	while (physicsThreadRunning)
+	{
+		{
+			std::lock_guard<std::mutex> lock(stepMutex);
+
+			if (!isPaused)
+			{
+				UpdatePhysics();
+
+				for (PhysicsNode* pnode : physicsNodes)
+				{
+					pnode->PublishTransform();
+				}
+
+				//Left alone while paused, so everything is drawn at its latest state rather than between the last two
+				lastStepTime = steady_clock::now();
+			}
+
+			nextStep += duration_cast<steady_clock::duration>(duration<float>(updateTimestep));
+		}
+
+		//Sleep until the next update is due. If we have fallen more than an update behind drop the lost time rather
+		// than trying to catch up, the same as Update() does
+		const steady_clock::time_point now = steady_clock::now();
+		if (now < nextStep)
+		{
+			std::this_thread::sleep_until(nextStep);
+		}
+		else if (now - nextStep > duration<float>(updateTimestep))
+		{
+			physicsThreadBehind = true;
+			nextStep = now;
+		}
+	}
+}
 
 void PhysicsEngine::Update(float deltaTime)
 {
+	//When physics has its own thread all that is left to do here is pass the latest transforms on to the
+	// GameObjects, interpolated by how far we are between the last two physics updates
+	// - The caller holds LockPhysics(), so the physics thread isn't part way through an update
+	if (isThreaded)
+	{
+		if (physicsThreadBehind.exchange(false))
+		{
+			NCLDebug::Log("Physics too slow to run in real time!");
+		}
+
+		const float elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - lastStepTime).count();
+		const float alpha = min(elapsed / updateTimestep, 1.0f);
+
+		for (PhysicsNode* pnode : physicsNodes)
+		{
+			pnode->FireOnUpdateCallback(alpha);
+		}
+
+		for (Cloth* cloth : cloths)
+		{
+			cloth->FireOnUpdateCallback();
+		}
+		return;
+	}
+
 	//The physics engine should run independantly to the renderer
-	// - As our codebase is currently single threaded we just need
+	// - Unless it has been given its own thread (see SetThreaded) we just need
 	//   a way of calling "UpdatePhysics()" at regular intervals
 	//   or multiple times a frame if the physics timestep is higher
 	//   than the renderers.
@@ -121,31 +450,32 @@ void PhysicsEngine::Update(float deltaTime)
 			updateRealTimeAccum = 0.0f;
 		}
 	}
-
-	for (PhysicsNode* pnode : physicsNodes)
-	{
-		pnode->UpdateRestTimer(deltaTime);
-	}
 }
 
 
 void PhysicsEngine::UpdatePhysics()
 {
-	for (Manifold* m : manifolds)
+	//The manifolds themselves are kept in the pair cache, this is just the list to solve
+	manifolds.clear();
+	physicsStep++;
+	inPhysicsUpdate = true;
+
+	//Everything allocated from the arenas last update has gone out of scope
+	for (FrameArena* arena : threadArenas)
 	{
-		delete m;
+		arena->Reset();
 	}
-	manifolds.clear();
 
 	perfUpdate.UpdateRealElapsedTime(updateTimestep);
 	perfBroadphase.UpdateRealElapsedTime(updateTimestep);
 	perfNarrowphase.UpdateRealElapsedTime(updateTimestep);
 	perfSolver.UpdateRealElapsedTime(updateTimestep);
+	perfCloth.UpdateRealElapsedTime(updateTimestep);
 
 
 
 
-	//A whole physics engine in 6 simple steps =D
+	//A whole physics engine in 8 simple steps =D
 	
 	//-- Using positions from last frame --
 //1. Broadphase Collision Detection (Fast and dirty)
@@ -158,10 +488,13 @@ void PhysicsEngine::UpdatePhysics()
 	NarrowPhaseCollisions();
 	perfNarrowphase.EndTimingSection();
 
+//3. Put islands that have stopped moving to sleep, and wake any that have been touched by a moving object
+	UpdateIslands();
+
 	std::random_shuffle(manifolds.begin(), manifolds.end());
-	std::random_shuffle(constraints.begin(), constraints.end());
+	std::random_shuffle(activeConstraints.begin(), activeConstraints.end());
 
-//3. Initialize Constraint Params (precompute elasticity/baumgarte factor etc)
+//4. Initialize Constraint Params (precompute elasticity/baumgarte factor etc)
 	//Optional step to allow constraints to 
 	// precompute values based off current velocities 
 	// before they are updated loop below.
@@ -170,13 +503,13 @@ void PhysicsEngine::UpdatePhysics()
 		m->PreSolverStep(updateTimestep);
 	}
 
-	for (Constraint* c : constraints)
+	for (Constraint* c : activeConstraints)
 	{
 		c->PreSolverStep(updateTimestep);
 	}
 
 
-//4. Update Velocities
+//5. Update Velocities
 	perfUpdate.BeginTimingSection();
 	for (PhysicsNode* obj : physicsNodes)
 	{
@@ -187,89 +520,142 @@ void PhysicsEngine::UpdatePhysics()
 	}
 	perfUpdate.EndTimingSection();
 
-//5. Constraint Solver
+//6. Constraint Solver
 	perfSolver.BeginTimingSection();
 
+	//The solver works on a copy of the velocities held in contiguous arrays, which are written back to the nodes once it has finished
+	solverBodies.Gather(physicsNodes);
+
+	//Apply the impulses carried over from last step
+	for (Manifold* m : manifolds)
+	{
+		m->WarmStart(solverBodies);
+	}
+
+	ColourSolverBatches();
+
 	//------Tut 7-------
-	for (size_t i = 0; i < SOLVER_ITERATIONS; ++i)
+	//Each colour is solved in parallel, with the colours still solved one after another (Gauss-Seidel between colours).
+	// Nothing in a colour shares an object, so the result doesn't depend on the number of threads.
+	const bool parallelSolve = manifolds.size() + activeConstraints.size() >= SOLVER_PARALLEL_MIN_ITEMS;
+	solverResiduals.assign(solverMaxIterations, 0.0f);
+	solverIterations = solverMaxIterations;
+#pragma omp parallel if (parallelSolve)
 	{
-		for (Manifold* m : manifolds)
+		for (unsigned int i = 0; i < solverMaxIterations; ++i)
 		{
-			m->ApplyImpulse();
-		}
+			float residual = 0.0f;
 
-		for (Constraint* c : constraints)
-		{
-			c->ApplyImpulse();
+			for (unsigned int colour = 0; colour < numSolverColours; ++colour)
+			{
+				SolverBatch& batch = solverBatches[colour];
+
+#pragma omp for schedule(static) nowait
+				for (int j = 0; j < (int)batch.manifolds.size(); ++j)
+				{
+					const float itemResidual = batch.manifolds[j]->ApplyImpulse(solverBodies);
+					residual = max(residual, itemResidual);
+				}
+
+#pragma omp for schedule(static)
+				for (int j = 0; j < (int)batch.constraints.size(); ++j)
+				{
+					const float itemResidual = batch.constraints[j]->ApplyImpulse(solverBodies);
+					residual = max(residual, itemResidual);
+				}
+			}
+
+#pragma omp single
+			{
+				SolverBatch& batch = solverBatches[SOLVER_MAX_COLOURS];
+				for (Manifold* m : batch.manifolds)
+				{
+					const float itemResidual = m->ApplyImpulse(solverBodies);
+					residual = max(residual, itemResidual);
+				}
+
+				for (Constraint* c : batch.constraints)
+				{
+					const float itemResidual = c->ApplyImpulse(solverBodies);
+					residual = max(residual, itemResidual);
+				}
+			}
+
+			//Combine each thread's residual (OpenMP 2.0 has no max reduction), then every thread makes the
+			// same decision on whether to stop
+#pragma omp critical
+			solverResiduals[i] = max(solverResiduals[i], residual);
+#pragma omp barrier
+
+			if (i + 1 >= solverMinIterations && solverResiduals[i] < solverTolerance)
+			{
+#pragma omp single nowait
+				solverIterations = i + 1;
+				break;
+			}
 		}
 	}
+
+	solverBodies.Scatter(physicsNodes);
 	perfSolver.EndTimingSection();
 
-//6. Update Positions (with final 'real' velocities)
+//7. Update Positions (with final 'real' velocities)
 	perfUpdate.BeginTimingSection();
+	//Bullets are moved first, so everything they are swept against is still where it was at the start of the step
+	UpdateBullets();
 	for (PhysicsNode* obj : physicsNodes)
 	{
-		if (!obj->GetAtRest())
+		if (!obj->GetAtRest() && !obj->IsBullet())
 		{
 			obj->IntegrateForPosition(updateTimestep);
 		}
 	}
 	perfUpdate.EndTimingSection();
-}
 
-bool PhysicsEngine::SweepSortFunc(PhysicsNode* nodeA, PhysicsNode* nodeB)
-{
-	if (nodeA->GetCollisionShape() != NULL && nodeB->GetCollisionShape() != NULL) 
+//8. Cloth
+	perfCloth.BeginTimingSection();
+	for (Cloth* cloth : cloths)
 	{
-		Vector3 xMinA = Vector3();
-		Vector3 xMaxA = Vector3();
-		Vector3 xMinB = Vector3();
-		Vector3 xMaxB = Vector3();
+		cloth->Update(updateTimestep, gravity, dampingFactor, physicsNodes);
 
-		//Check X
-		nodeA->GetCollisionShape()->GetMinMaxVertexOnAxis(Vector3(1, 0, 0), xMinA, xMaxA);
-		nodeA->SetMinX(xMinA.x);
-		nodeA->SetMaxX(xMaxA.x);
-		nodeB->GetCollisionShape()->GetMinMaxVertexOnAxis(Vector3(1, 0, 0), xMinB, xMaxB);
-		nodeB->SetMinX(xMinB.x);
-		nodeB->SetMaxX(xMaxB.x);
+		//Threaded physics updates the cloth meshes from the game thread (see Update)
+		if (!isThreaded) cloth->FireOnUpdateCallback();
+	}
+	perfCloth.EndTimingSection();
 
-		//Check Z
-		if (xMinA.x < xMinB.x)
-		{
-			Vector3 zMinA = Vector3();
-			Vector3 zMaxA = Vector3();
-			Vector3 zMinB = Vector3();
-			Vector3 zMaxB = Vector3();
+	inPhysicsUpdate = false;
+	ApplyPendingObjectChanges();
+}
 
-			nodeA->GetCollisionShape()->GetMinMaxVertexOnAxis(Vector3(0, 0, 1), zMinA, zMaxA);
-			nodeA->SetMinZ(zMinA.z);
-			nodeA->SetMaxZ(zMaxA.z);
-			nodeB->GetCollisionShape()->GetMinMaxVertexOnAxis(Vector3(0, 0, 1), zMinB, zMaxB);
-			nodeB->SetMinZ(zMinB.z);
-			nodeB->SetMaxZ(zMaxB.z);
+void PhysicsEngine::ApplyPendingObjectChanges()
+{
+	//Swapped out first, as the exit callbacks fired by each removal can remove further objects
+	std::vector<PhysicsNode*> additions, removals, deletions;
+	additions.swap(pendingAdditions);
+	removals.swap(pendingRemovals);
+	deletions.swap(pendingDeletions);
 
-			return zMinA.z < zMinB.z;
-		}
+	for (PhysicsNode* obj : additions)
+	{
+		AddPhysicsObject(obj);
+	}
+
+	for (PhysicsNode* obj : removals)
+	{
+		RemovePhysicsObject(obj);
+	}
+
+	for (PhysicsNode* obj : deletions)
+	{
+		DeletePhysicsObject(obj);
 	}
-	return true;
 }
 
 void PhysicsEngine::BroadPhaseCollisions()
 {
-	//OCTREES
-	//SORT AND SWEEP
-
 	numSphereSphereChecks = 0;
 	broadphaseColPairs.clear();
 
-	//Update rest states
-	for (PhysicsNode* pnode : physicsNodes)
-	{
-		pnode->UpdateVelocities();
-		pnode->DetermineRestState();
-	}
-
 	PhysicsNode *pnodeA, *pnodeB;
 	//	The broadphase needs to build a list of all potentially colliding objects in the world,
 	//	which then get accurately assesed in narrowphase. If this is too coarse then the system slows down with
@@ -277,12 +663,29 @@ void PhysicsEngine::BroadPhaseCollisions()
 
 	if (physicsNodes.size() > 0)
 	{
-		if (useOctrees)
+		if (broadphaseMode == BROADPHASE_OCTREE)
+		{
+			//Reinsert any nodes that have moved too far then generate collision pairs from the octree
+			m_octree->updateObjects();
+			m_octree->genPairs(broadphaseColPairs);
+		}
+		else if (broadphaseMode == BROADPHASE_SORTANDSWEEP)
+		{
+			//Re-sort the endpoints from the last update then sweep them for overlapping pairs
+			m_sortAndSweep->UpdateObjects();
+			m_sortAndSweep->GenPairs(broadphaseColPairs);
+		}
+		else if (broadphaseMode == BROADPHASE_AABBTREE)
+		{
+			//Reinsert any nodes that have left their fat AABBs then query the tree for overlapping pairs
+			m_aabbTree->UpdateObjects();
+			m_aabbTree->GenPairs(broadphaseColPairs);
+		}
+		else if (broadphaseMode == BROADPHASE_UNIFORMGRID)
 		{
-			//Build the octree then generate collision pairs from it
-			m_octree->updateObjects(physicsNodes);
-			m_octree->buildOctree();
-			m_octree->getRoot()->genPairs(broadphaseColPairs);
+			//Bucket sort the nodes into grid cells then check each node against its neighbouring cells
+			m_uniformGrid->UpdateObjects();
+			m_uniformGrid->GenPairs(broadphaseColPairs);
 		}
 		else
 		{
@@ -297,9 +700,8 @@ void PhysicsEngine::BroadPhaseCollisions()
 					pnodeA = physicsNodes[i];
 					pnodeB = physicsNodes[j];
 
-					//Check they both atleast have collision shapes
-					if (pnodeA->GetCollisionShape() != NULL
-						&& pnodeB->GetCollisionShape() != NULL)
+					//Check they both atleast have collision shapes and aren't both at rest or in the same soft body
+					if (IsBroadphasePair(pnodeA, pnodeB))
 					{
 						CollisionPair cp;
 						cp.pObjectA = pnodeA;
@@ -320,49 +722,68 @@ void PhysicsEngine::BroadPhaseCollisions()
 
 void PhysicsEngine::SphereSphereCheck()
 {
-	//broadphaseColPairs = SphereSpherePairs();
-	PhysicsNode *pnodeA, *pnodeB;
+	//Every broadphase has already removed pairs that are both at rest, in the same soft body or missing a
+	//collision shape, so this only needs to check the bounding spheres.
+	const size_t numPairs = broadphaseColPairs.size();
+	numSphereSphereChecks += (int)numPairs;
 
-	if (broadphaseColPairs.size() > 0)
+	if (numPairs == 0)
 	{
-		std::vector<CollisionPair> oldPairs = broadphaseColPairs;
-		broadphaseColPairs.clear();
+		return;
+	}
 
-		for (CollisionPair cp : oldPairs)
-		{
-			pnodeA = cp.pObjectA;
-			pnodeB = cp.pObjectB;
+	//Gather the separation and combined radius of each pair into SoA arrays so they can be tested 4 at a time
+	// - The arrays are padded to a multiple of 4 with pairs that never pass
+	// - They are kept between updates so they only allocate when the number of pairs grows
+	const size_t numPadded = (numPairs + 3) & ~(size_t)3;
+	sphereDX.resize(numPadded);
+	sphereDY.resize(numPadded);
+	sphereDZ.resize(numPadded);
+	sphereRadius.resize(numPadded);
 
-			//if both objects are at rest then there is no need to check for collision
-			if (pnodeA->GetAtRest() && pnodeB->GetAtRest())
-			{
-				continue;
-			}
+	for (size_t i = 0; i < numPairs; ++i)
+	{
+		const PhysicsNode* pnodeA = broadphaseColPairs[i].pObjectA;
+		const PhysicsNode* pnodeB = broadphaseColPairs[i].pObjectB;
+		const Vector3& posA = pnodeA->GetPosition();
+		const Vector3& posB = pnodeB->GetPosition();
+
+		sphereDX[i] = posA.x - posB.x;
+		sphereDY[i] = posA.y - posB.y;
+		sphereDZ[i] = posA.z - posB.z;
+		sphereRadius[i] = pnodeA->GetBoundingRadius() + pnodeB->GetBoundingRadius();
+	}
 
-			//if both nodes have the same soft body id then don't check collision
-			if (pnodeA->GetSoftBodyID() == pnodeB->GetSoftBodyID() && pnodeA->GetSoftBodyID() != NULL)
-			{
-				continue;
-			}
+	for (size_t i = numPairs; i < numPadded; ++i)
+	{
+		sphereDX[i] = 1.0f;
+		sphereDY[i] = sphereDZ[i] = sphereRadius[i] = 0.0f;
+	}
 
-			//Check they both atleast have collision shapes
-			if (pnodeA->GetCollisionShape() != NULL
-				&& pnodeB->GetCollisionShape() != NULL)
-			{
-				numSphereSphereChecks++;
+	//Compare squared distances against squared radii, then compact the surviving pairs in place
+	// - Every pair is copied to the current output slot and the slot only advances if the pair passed,
+	//   so there are no per pair branches. The output never overtakes the input so nothing is overwritten early.
+	size_t numKept = 0;
+	for (size_t i = 0; i < numPadded; i += 4)
+	{
+		const __m128 dx = _mm_loadu_ps(&sphereDX[i]);
+		const __m128 dy = _mm_loadu_ps(&sphereDY[i]);
+		const __m128 dz = _mm_loadu_ps(&sphereDZ[i]);
+		const __m128 radius = _mm_loadu_ps(&sphereRadius[i]);
 
-				Vector3 dist = pnodeA->GetPosition() - pnodeB->GetPosition();
-				//if distance between the two objects is less than the sum of their bounding radii then they might be colliding
-				if (dist.Length() <= pnodeA->GetBoundingRadius() + pnodeB->GetBoundingRadius())
-				{
-					CollisionPair cp;
-					cp.pObjectA = pnodeA;
-					cp.pObjectB = pnodeB;
-					broadphaseColPairs.push_back(cp);
-				}
-			}
+		const __m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+		const int mask = _mm_movemask_ps(_mm_cmple_ps(distSq, _mm_mul_ps(radius, radius)));
+
+		const size_t end = min(i + 4, numPairs);
+		for (size_t j = i; j < end; ++j)
+		{
+			broadphaseColPairs[numKept] = broadphaseColPairs[j];
+			numKept += (mask >> (j - i)) & 1;
 		}
 	}
+
+	//Shrinking never reallocates
+	broadphaseColPairs.resize(numKept);
 }
 
 
@@ -370,75 +791,615 @@ void PhysicsEngine::NarrowPhaseCollisions()
 {
 	if (broadphaseColPairs.size() > 0)
 	{
-		//Collision data to pass between detection and manifold generation stages.
-		CollisionData colData;				
+		const int numPairs = (int)broadphaseColPairs.size();
 
-		//Collision Detection Algorithm to use
-		CollisionDetectionSAT colDetect;	
-
-		// Iterate over all possible collision pairs and perform accurate collision detection
-		for (size_t i = 0; i < broadphaseColPairs.size(); ++i)
+		threadColResults.resize(omp_get_max_threads());
+		while (threadArenas.size() < threadColResults.size())
+		{
+			threadArenas.push_back(new FrameArena());
+		}
+		for (std::vector<NarrowphaseResult>& results : threadColResults)
 		{
-			CollisionPair& cp = broadphaseColPairs[i];
+			results.clear();
+		}
 
-			CollisionShape *shapeA = cp.pObjectA->GetCollisionShape();
-			CollisionShape *shapeB = cp.pObjectB->GetCollisionShape();
+		threadNewPairAxes.resize(threadColResults.size());
 
-			colDetect.BeginNewPair(
-				cp.pObjectA,
-				cp.pObjectB,
-				cp.pObjectA->GetCollisionShape(),
-				cp.pObjectB->GetCollisionShape());
+		//Detection and contact generation only read the two physics nodes so every pair can be processed in
+		//parallel. Each thread has its own detector and results buffer, and handles one contiguous block of
+		//pairs, so merging the buffers in thread order gives the same order as the broadphase pairs.
+#pragma omp parallel
+		{
+			std::vector<NarrowphaseResult>& results = threadColResults[omp_get_thread_num()];
+			std::vector<NewPairAxis>& newAxes = threadNewPairAxes[omp_get_thread_num()];
+
+			//Collision Detection Algorithms to use
+			CollisionDetectionSAT colDetect(threadArenas[omp_get_thread_num()]);
+			CollisionDetectionGJK gjkDetect(threadArenas[omp_get_thread_num()]);
+			const bool useGJK = (narrowphaseMode == NARROWPHASE_GJK);
 
-			//--TUTORIAL 4 CODE--
-			// Detects if the objects are colliding
-			if (colDetect.AreColliding(&colData))
+#pragma omp for schedule(static)
+			for (int i = 0; i < numPairs; ++i)
 			{
-				//Note: As at the end of tutorial 4 we have very little to do, this is a bit messier
-				//      than it should be. We now fire oncollision events for the two objects so they
-				//      can handle AI and also optionally draw the collision normals to see roughly
-				//      where and how the objects are colliding.
+				CollisionPair& cp = broadphaseColPairs[i];
 
-				//Draw collision data to the window if requested
-				// - Have to do this here as colData is only temporary. 
-				if (debugDrawFlags & DEBUGDRAW_FLAGS_COLLISIONNORMALS)
+				CollisionShape *shapeA = cp.pObjectA->GetCollisionShape();
+				CollisionShape *shapeB = cp.pObjectB->GetCollisionShape();
+
+				//Collision data to pass between detection and manifold generation stages.
+				NarrowphaseResult result;
+
+				//Use the closed form test for this pair of shapes if there is one, otherwise fall back to SAT or GJK
+				CollisionTestFunc colTest = CollisionDispatch::GetCollisionTest(shapeA, shapeB);
+				const bool pairUsesGJK = useGJK || CollisionDispatch::RequiresGJK(shapeA, shapeB);
+
+				bool colliding;
+				if (colTest)
 				{
-					NCLDebug::DrawPointNDT(colData._pointOnPlane, 0.1f, Vector4(0.5f, 0.5f, 1.0f, 1.0f));
-					NCLDebug::DrawThickLineNDT(colData._pointOnPlane, colData._pointOnPlane - colData._normal * colData._penetration, 0.05f, Vector4(0.0f, 0.0f, 1.0f, 1.0f));
+					colliding = colTest(cp.pObjectA, cp.pObjectB, result.colData);
 				}
+				else
+				{
+					//Test the axis that separated the pair last step first (see pairAxisCache)
+					const uint64_t pairKey = PairHashSet::PairKey(cp.pObjectA, cp.pObjectB);
+					auto foundAxis = pairAxisCache.find(pairKey);
+					CachedPairAxis* cachedAxis = (foundAxis != pairAxisCache.end()) ? &foundAxis->second : NULL;
 
-				//Check to see if any of the objects have a OnCollision callback that dont want the objects to physically collide
-				bool okA = cp.pObjectA->FireOnCollisionEvent(cp.pObjectA, cp.pObjectB);
-				bool okB = cp.pObjectB->FireOnCollisionEvent(cp.pObjectB, cp.pObjectA);
+					Vector3 resultAxis;
+					if (pairUsesGJK)
+					{
+						gjkDetect.BeginNewPair(
+							cp.pObjectA,
+							cp.pObjectB,
+							shapeA,
+							shapeB,
+							cachedAxis ? &cachedAxis->axis : NULL);
+
+						colliding = gjkDetect.AreColliding(&result.colData);
+						resultAxis = gjkDetect.GetResultAxis();
+					}
+					else
+					{
+						colDetect.BeginNewPair(
+							cp.pObjectA,
+							cp.pObjectB,
+							shapeA,
+							shapeB,
+							cachedAxis ? &cachedAxis->axis : NULL);
+
+						//--TUTORIAL 4 CODE--
+						// Detects if the objects are colliding
+						colliding = colDetect.AreColliding(&result.colData);
+						resultAxis = colDetect.GetResultAxis();
+					}
 
-				if (okA && okB)
+					//Each pair is only handled by one thread so its entry can be updated in place, but new entries
+					// have to wait until after the parallel section
+					if (cachedAxis)
+					{
+						cachedAxis->axis = resultAxis;
+						cachedAxis->lastStep = physicsStep;
+					}
+					else
+					{
+						NewPairAxis newAxis;
+						newAxis.key = pairKey;
+						newAxis.axis = resultAxis;
+						newAxes.push_back(newAxis);
+					}
+				}
+
+				if (colliding)
 				{
 					/* TUTORIAL 5 CODE */
 					//Build full collision manifold that will also handle the
 					//collision response between the two objects in the solver
-					//stage
-
-					Manifold* manifold = new Manifold();
-					manifold->Initiate(cp.pObjectA, cp.pObjectB);
+					//stage. The cache is only read here, new pairs are added to it after the parallel section.
+					result.pair = cp;
+					auto found = pairCache.find(PairHashSet::PairKey(cp.pObjectA, cp.pObjectB));
+					result.cached = (found != pairCache.end()) ? &found->second : NULL;
 
-					//Construct contact points that form the perimeter of the collision manifold
-					colDetect.GenContactPoints(manifold);
-
-					if (manifold->contactPoints.size() > 0)
+					if (result.cached && !result.cached->respond)
 					{
-						//Add to list of manifolds that need solving
-						manifolds.push_back(manifold);
+						//Dropped by an enter callback when the pair started touching, it only needs to be kept in the cache
+						result.manifold = NULL;
 					}
 					else
 					{
-						delete manifold;
+						result.manifold = (result.cached && result.cached->manifold) ? result.cached->manifold : AllocManifold();
+						result.manifold->Initiate(cp.pObjectA, cp.pObjectB);
+
+						//Construct contact points that form the perimeter of the collision manifold
+						if (colTest)
+						{
+							CollisionDispatch::GenContactPoint(result.colData, result.manifold);
+						}
+						else if (pairUsesGJK)
+						{
+							gjkDetect.GenContactPoints(result.manifold);
+						}
+						else
+						{
+							colDetect.GenContactPoints(result.manifold);
+						}
+					}
+
+					results.push_back(result);
+				}
+			}
+		}
+
+		//Callbacks run game code and debug drawing isn't thread safe, so both are done on this thread in pair order
+		for (std::vector<NarrowphaseResult>& results : threadColResults)
+		{
+			for (NarrowphaseResult& result : results)
+			{
+				const CollisionData& colData = result.colData;
+				CollisionPair& cp = result.pair;
+
+				//Draw collision data to the window if requested
+				// - Have to do this here as colData is only temporary. 
+				// - NCLDebug isn't thread safe either, so this is skipped when running on the physics thread
+				if (!isThreaded && (debugDrawFlags & DEBUGDRAW_FLAGS_COLLISIONNORMALS))
+				{
+					NCLDebug::DrawPointNDT(colData._pointOnPlane, 0.1f, Vector4(0.5f, 0.5f, 1.0f, 1.0f));
+					NCLDebug::DrawThickLineNDT(colData._pointOnPlane, colData._pointOnPlane - colData._normal * colData._penetration, 0.05f, Vector4(0.0f, 0.0f, 1.0f, 1.0f));
+				}
+
+				//Check to see if any of the objects have a OnCollision callback that dont want the objects to physically collide
+				CachedPair* cached = result.cached;
+				const bool respond = TouchPair(cp.pObjectA, cp.pObjectB, cached);
+
+				if (respond && result.manifold && result.manifold->GetNumContacts() > 0)
+				{
+					//Add to list of manifolds that need solving
+					manifolds.push_back(result.manifold);
+					cached->manifold = result.manifold;
+				}
+				else
+				{
+					if (result.manifold)
+					{
+						FreeManifold(result.manifold);
 					}
+					cached->manifold = NULL;
+				}
+			}
+		}
+	}
+
+	//Cache the axes of the pairs tested for the first time, and forget any pairs that weren't tested this step
+	for (std::vector<NewPairAxis>& newAxes : threadNewPairAxes)
+	{
+		for (const NewPairAxis& newAxis : newAxes)
+		{
+			CachedPairAxis cached;
+			cached.axis = newAxis.axis;
+			cached.lastStep = physicsStep;
+			pairAxisCache[newAxis.key] = cached;
+		}
+		newAxes.clear();
+	}
+
+	for (auto itr = pairAxisCache.begin(); itr != pairAxisCache.end();)
+	{
+		if (itr->second.lastStep != physicsStep)
+		{
+			itr = pairAxisCache.erase(itr);
+		}
+		else
+		{
+			++itr;
+		}
+	}
+
+	RemoveSeparatedPairs();
+}
+
+bool PhysicsEngine::TouchPair(PhysicsNode* pnodeA, PhysicsNode* pnodeB, CachedPair*& cached)
+{
+	if (!cached)
+	{
+		CachedPair& pair = pairCache[PairHashSet::PairKey(pnodeA, pnodeB)];
+		pair.nodeA = pnodeA;
+		pair.nodeB = pnodeB;
+		pair.manifold = NULL;
+		cached = &pair;
+
+		//Both callbacks are always fired, so neither object misses the other arriving
+		bool okA = pnodeA->FireOnCollisionEnterEvent(pnodeA, pnodeB);
+		bool okB = pnodeB->FireOnCollisionEnterEvent(pnodeB, pnodeA);
+		cached->respond = okA && okB;
+	}
+	cached->lastStep = physicsStep;
+
+	bool okA = pnodeA->FireOnCollisionEvent(pnodeA, pnodeB);
+	bool okB = pnodeB->FireOnCollisionEvent(pnodeB, pnodeA);
+	return cached->respond && okA && okB;
+}
+
+void PhysicsEngine::RemoveSeparatedPairs()
+{
+	//Forget any pairs that are no longer touching
+	// - Pairs of sleeping nodes aren't checked by the broadphase, so they are kept until one of them wakes up
+	std::vector<CollisionPair> separatedPairs;
+	for (auto itr = pairCache.begin(); itr != pairCache.end();)
+	{
+		CachedPair& pair = itr->second;
+		if (pair.lastStep != physicsStep && !(pair.nodeA->GetAtRest() && pair.nodeB->GetAtRest()))
+		{
+			if (pair.manifold)
+			{
+				FreeManifold(pair.manifold);
+			}
+
+			CollisionPair cp;
+			cp.pObjectA = pair.nodeA;
+			cp.pObjectB = pair.nodeB;
+			separatedPairs.push_back(cp);
+			itr = pairCache.erase(itr);
+		}
+		else
+		{
+			++itr;
+		}
+	}
+
+	//Callbacks are fired once the cache is no longer being walked
+	// - Any objects they add or remove are held until the end of the update (see ApplyPendingObjectChanges)
+	for (const CollisionPair& cp : separatedPairs)
+	{
+		cp.pObjectA->FireOnCollisionExitEvent(cp.pObjectA, cp.pObjectB);
+		cp.pObjectB->FireOnCollisionExitEvent(cp.pObjectB, cp.pObjectA);
+	}
+}
+
+void PhysicsEngine::UpdateBullets()
+{
+	for (PhysicsNode* bullet : physicsNodes)
+	{
+		if (!bullet->IsBullet() || bullet->GetAtRest())
+		{
+			continue;
+		}
+
+		const float radius = bullet->GetSweptRadius();
+		float remaining = updateTimestep;
+		bulletIgnored.clear();
+
+		for (unsigned int substep = 0; substep < CCD_MAX_SUBSTEPS && remaining > 0.0f; ++substep)
+		{
+			const Vector3 start = bullet->GetPosition();
+			const Vector3 motion = bullet->GetLinearVelocity() * remaining;
+
+			//Slow enough that the narrowphase can't miss anything
+			if (Vector3::Dot(motion, motion) <= radius * radius * CCD_MOTION_THRESHOLD * CCD_MOTION_THRESHOLD)
+			{
+				break;
+			}
+
+			//Everything the swept sphere could reach this step
+			BoundingBox sweep;
+			sweep.ExpandToFit(start);
+			sweep.ExpandToFit(start + motion);
+			sweep._min = sweep._min - Vector3(radius, radius, radius);
+			sweep._max = sweep._max + Vector3(radius, radius, radius);
+			QueryBroadphase(sweep, bulletCandidates);
+
+			//Find the first impact
+			// - Each node is swept against where it started the step, so its own motion up to now and over the rest
+			//   of the step is taken off the bullet's
+			const float elapsed = updateTimestep - remaining;
+			PhysicsNode* hitNode = NULL;
+			float hitFraction = 1.0f;
+			Vector3 hitNormal, hitPosition;
+			for (PhysicsNode* other : bulletCandidates)
+			{
+				if (other == bullet || !IsBroadphasePair(bullet, other)
+					|| std::find(bulletIgnored.begin(), bulletIgnored.end(), other) != bulletIgnored.end())
+				{
+					continue;
 				}
+
+				const Vector3 relStart = start - other->GetLinearVelocity() * elapsed;
+				const Vector3 relMotion = motion - other->GetLinearVelocity() * remaining;
+
+				float fraction;
+				Vector3 normal;
+				if (ContinuousCollision::SweepSphere(relStart, relMotion, radius, other, fraction, normal) && fraction < hitFraction)
+				{
+					hitNode = other;
+					hitFraction = fraction;
+					hitNormal = normal;
+					hitPosition = relStart + relMotion * fraction;
+				}
+			}
+
+			if (!hitNode)
+			{
+				break;
+			}
+
+			//Move up to the impact
+			const float dt = remaining * hitFraction;
+			bullet->IntegrateForPosition(dt);
+			remaining -= dt;
+
+			//Check to see if either object has a OnCollision callback that doesn't want the objects to physically collide,
+			// the same as the narrowphase
+			auto found = pairCache.find(PairHashSet::PairKey(bullet, hitNode));
+			CachedPair* cached = (found != pairCache.end()) ? &found->second : NULL;
+
+			if (TouchPair(bullet, hitNode, cached))
+			{
+				const Vector3 contact = hitPosition - hitNormal * radius;
+				ResolveBulletImpact(bullet, hitNode, -hitNormal * radius, contact - hitNode->GetPosition(), hitNormal);
+			}
+			else
+			{
+				bulletIgnored.push_back(hitNode);
+			}
+		}
+
+		//The rest of the step can't hit anything (or has run out of substeps)
+		if (remaining > 0.0f)
+		{
+			bullet->IntegrateForPosition(remaining);
+		}
+	}
+}
+
+void PhysicsEngine::QueryBroadphase(const BoundingBox& bounds, std::vector<PhysicsNode*>& out_nodes)
+{
+	out_nodes.clear();
+
+	if (m_aabbTree)
+	{
+		m_aabbTree->Query(bounds, out_nodes);
+		return;
+	}
+
+	//The other broadphases can only generate pairs, so just check every node
+	for (PhysicsNode* pnode : physicsNodes)
+	{
+		if (pnode->GetWorldSpaceAABB().Intersects(bounds))
+		{
+			out_nodes.push_back(pnode);
+		}
+	}
+}
+
+void PhysicsEngine::ResolveBulletImpact(PhysicsNode* bullet, PhysicsNode* other, const Vector3& relPosBullet, const Vector3& relPosOther, const Vector3& normal)
+{
+	const Vector3 v0 = bullet->GetLinearVelocity() + Vector3::Cross(bullet->GetAngularVelocity(), relPosBullet);
+	const Vector3 v1 = other->GetLinearVelocity() + Vector3::Cross(other->GetAngularVelocity(), relPosOther);
+	const Vector3 dv = v0 - v1;
+
+	//Already separating
+	const float normalVelocity = Vector3::Dot(dv, normal);
+	if (normalVelocity >= 0.0f)
+	{
+		return;
+	}
+
+	//Inverse of the effective mass of the two nodes at the contact along the given axis
+	auto constraintMass = [&](const Vector3& axis)
+	{
+		return bullet->GetInverseMass() + other->GetInverseMass() +
+			Vector3::Dot(axis,
+				Vector3::Cross(bullet->GetInverseInertia() * Vector3::Cross(relPosBullet, axis), relPosBullet) +
+				Vector3::Cross(other->GetInverseInertia() * Vector3::Cross(relPosOther, axis), relPosOther));
+	};
+
+	const float normalMass = constraintMass(normal);
+	if (normalMass <= 0.0f)
+	{
+		return;
+	}
+
+	//Bounce, using the same elasticity and friction coefficients as Manifold
+	const float elasticity = bullet->GetElasticity() * other->GetElasticity();
+	const float jn = -(1.0f + elasticity) * normalVelocity / normalMass;
+	Vector3 impulse = normal * jn;
+
+	Vector3 tangent = dv - normal * normalVelocity;
+	const float tangentLength = tangent.Length();
+	if (tangentLength > 1e-6f)
+	{
+		tangent = tangent / tangentLength;
+
+		const float frictionalMass = constraintMass(tangent);
+		if (frictionalMass > 0.0f)
+		{
+			//Never more than enough to stop the sliding, or more than friction allows for the normal impulse
+			const float jtStop = tangentLength / frictionalMass;
+			const float jtMax = bullet->GetFriction() * other->GetFriction() * jn;
+			const float jt = min(jtStop, jtMax);
+			impulse = impulse - tangent * jt;
+		}
+	}
+
+	if (bullet->GetInverseMass() > 0.0f)
+	{
+		bullet->SetLinearVelocity(bullet->GetLinearVelocity() + impulse * bullet->GetInverseMass());
+		bullet->SetAngularVelocity(bullet->GetAngularVelocity() + bullet->GetInverseInertia() * Vector3::Cross(relPosBullet, impulse));
+	}
+
+	if (other->GetInverseMass() > 0.0f)
+	{
+		other->SetLinearVelocity(other->GetLinearVelocity() - impulse * other->GetInverseMass());
+		other->SetAngularVelocity(other->GetAngularVelocity() - other->GetInverseInertia() * Vector3::Cross(relPosOther, impulse));
+
+		//Sleeping nodes are woken straight away, so they are moved along with everything else this step
+		other->WakeUp();
+	}
+}
+
+void PhysicsEngine::UpdateIslands()
+{
+	//Build islands of dynamic nodes joined by manifolds and constraints
+	// - Static nodes are left out, otherwise everything resting on the floor would be one big island
+	islandParent.resize(physicsNodes.size());
+	islandAwake.assign(physicsNodes.size(), 0);
+	for (size_t i = 0; i < physicsNodes.size(); ++i)
+	{
+		physicsNodes[i]->SetBodyIndex((unsigned int)i);
+		physicsNodes[i]->UpdateSleepTimer(updateTimestep);
+		islandParent[i] = (unsigned int)i;
+	}
+
+	//The cache holds this step's manifolds along with the manifolds between sleeping nodes
+	for (auto& itr : pairCache)
+	{
+		if (itr.second.manifold)
+		{
+			LinkIsland(itr.second.nodeA, itr.second.nodeB);
+		}
+	}
+
+	for (Constraint* c : constraints)
+	{
+		if (c->NodeA() && c->NodeB())
+		{
+			LinkIsland(c->NodeA(), c->NodeB());
+		}
+	}
+
+	//An island stays awake while any of its nodes are still moving
+	for (PhysicsNode* pnode : physicsNodes)
+	{
+		if (pnode->GetInverseMass() > 0.0f && pnode->GetSleepTimer() < SLEEP_TIME)
+		{
+			islandAwake[FindIsland(pnode->GetBodyIndex())] = 1;
+		}
+	}
+
+	//Put the nodes of each island to sleep or wake them together
+	numSleepingNodes = 0;
+	for (PhysicsNode* pnode : physicsNodes)
+	{
+		if (pnode->GetInverseMass() > 0.0f)
+		{
+			const bool sleep = !islandAwake[FindIsland(pnode->GetBodyIndex())];
+			if (sleep && !pnode->GetAtRest())
+			{
+				pnode->SetLinearVelocity(Vector3(0.0f, 0.0f, 0.0f));
+				pnode->SetAngularVelocity(Vector3(0.0f, 0.0f, 0.0f));
+			}
+			else if (!sleep && pnode->GetAtRest())
+			{
+				//Nodes woken by the rest of their island get a full SLEEP_TIME before they can sleep again
+				pnode->WakeUp();
 			}
+			pnode->SetAtRest(sleep);
+		}
+		else
+		{
+			//Static nodes only need to be awake while they're being moved
+			pnode->SetAtRest(pnode->GetSleepTimer() > 0.0f);
 		}
+
+		if (pnode->GetAtRest())
+		{
+			++numSleepingNodes;
+		}
+	}
+
+	//Drop anything between two sleeping nodes from this step's solve
+	manifolds.erase(std::remove_if(manifolds.begin(), manifolds.end(),
+		[](Manifold* m) { return m->NodeA()->GetAtRest() && m->NodeB()->GetAtRest(); }), manifolds.end());
+
+	activeConstraints.clear();
+	for (Constraint* c : constraints)
+	{
+		if (!c->NodeA() || !c->NodeB() || !c->NodeA()->GetAtRest() || !c->NodeB()->GetAtRest())
+		{
+			activeConstraints.push_back(c);
+		}
+	}
+}
+
+void PhysicsEngine::LinkIsland(PhysicsNode* pnodeA, PhysicsNode* pnodeB)
+{
+	const bool dynamicA = pnodeA->GetInverseMass() > 0.0f;
+	const bool dynamicB = pnodeB->GetInverseMass() > 0.0f;
+
+	if (dynamicA && dynamicB)
+	{
+		unsigned int rootA = FindIsland(pnodeA->GetBodyIndex());
+		unsigned int rootB = FindIsland(pnodeB->GetBodyIndex());
+		if (rootA != rootB)
+		{
+			islandParent[rootA] = rootB;
+		}
+	}
+	//A static node being moved (e.g. dragged by the mouse) wakes whatever it touches
+	else if (dynamicA && !dynamicB && pnodeB->GetSleepTimer() <= 0.0f)
+	{
+		pnodeA->WakeUp();
+	}
+	else if (dynamicB && !dynamicA && pnodeA->GetSleepTimer() <= 0.0f)
+	{
+		pnodeB->WakeUp();
+	}
+}
+
+void PhysicsEngine::ColourSolverBatches()
+{
+	for (SolverBatch& batch : solverBatches)
+	{
+		batch.manifolds.clear();
+		batch.constraints.clear();
+	}
+	numSolverColours = 0;
+	nodeColours.assign(physicsNodes.size(), 0);
+
+	for (Manifold* m : manifolds)
+	{
+		solverBatches[PickSolverColour(m->NodeA(), m->NodeB())].manifolds.push_back(m);
+	}
+
+	for (Constraint* c : activeConstraints)
+	{
+		//Constraints that don't say which objects they join can't be coloured
+		const unsigned int colour = (c->NodeA() && c->NodeB()) ? PickSolverColour(c->NodeA(), c->NodeB()) : SOLVER_MAX_COLOURS;
+		solverBatches[colour].constraints.push_back(c);
 	}
 }
 
+unsigned int PhysicsEngine::PickSolverColour(PhysicsNode* pnodeA, PhysicsNode* pnodeB)
+{
+	//Static objects are never written to by the solver so they can be shared between any number of
+	// manifolds/constraints in a colour (otherwise everything on the floor would need its own colour)
+	const bool dynamicA = pnodeA->GetInverseMass() > 0.0f;
+	const bool dynamicB = pnodeB->GetInverseMass() > 0.0f;
+
+	uint64_t used = 0;
+	if (dynamicA) used |= nodeColours[pnodeA->GetBodyIndex()];
+	if (dynamicB) used |= nodeColours[pnodeB->GetBodyIndex()];
+
+	if (~used == 0)
+	{
+		return SOLVER_MAX_COLOURS;
+	}
+
+	//Lowest colour not used by either object
+	unsigned int colour = 0;
+	while (used & (uint64_t(1) << colour))
+	{
+		++colour;
+	}
+
+	const uint64_t bit = uint64_t(1) << colour;
+	if (dynamicA) nodeColours[pnodeA->GetBodyIndex()] |= bit;
+	if (dynamicB) nodeColours[pnodeB->GetBodyIndex()] |= bit;
+
+	numSolverColours = max(numSolverColours, colour + 1);
+	return colour;
+}
+
+
+
 
 void PhysicsEngine::DebugRender()
 {
@@ -458,6 +1419,11 @@ void PhysicsEngine::DebugRender()
 		{
 			c->DebugDraw();
 		}
+
+		for (Cloth* cloth : cloths)
+		{
+			cloth->DebugDraw();
+		}
 	}
 
 	// Draw all associated collision shapes
@@ -478,6 +1444,11 @@ void PhysicsEngine::DebugRender()
 		{
 			m_octree->debugDraw();
 		}
+
+		if (m_aabbTree)
+		{
+			m_aabbTree->DebugDraw();
+		}
 	}
 
 	if (debugDrawFlags & DEBUGDRAW_FLAGS_BOUNDINGRADIUS)
@@ -21,7 +21,8 @@ Description:
 			 - Narrowphase Collision Detection
 			   Takes the list provided by the broadphase collision detection and 
 			   accurately collides all objects, building a collision manifold as
-			   required. (Tutorial 4/5)
+			   required. (Tutorial 4/5) Touching pairs are kept between steps, so
+			   objects can be told when they start and stop touching each other.
 
 			 - Solve Constraints & Collisions
 			   Solves all velocity constraints in the physics system, these include
@@ -30,7 +31,8 @@ Description:
 
 			 - Update Physics Objects
 			   Moves all physics objects through time, updating positions/rotations
-			   etc. each iteration (Tutorial 2)
+			   etc. each iteration (Tutorial 2). Bullets are swept through the step
+			   first, so they stop at anything they would otherwise pass through.
 
 *//////////////////////////////////////////////////////////////////////////////
 
@@ -38,12 +40,26 @@ Description:
 #include "PhysicsNode.h"
 #include "Constraint.h"
 #include "Manifold.h"
+#include "SolverBodies.h"
+#include "FrameArena.h"
+#include "Cloth.h"
+#include "CollisionDetectionSAT.h"
+#include "CollisionDetectionGJK.h"
+#include "ContinuousCollision.h"
 #include "Octree.h"
+#include "SortAndSweep.h"
+#include "DynamicAABBTree.h"
+#include "UniformGrid.h"
+#include "PairHashSet.h"
 
-#include <nclgl\TSingleton.h>
-#include <nclgl\PerfTimer.h>
+#include <nclgl/TSingleton.h>
+#include <nclgl/PerfTimer.h>
 #include <vector>
+#include <unordered_map>
 #include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
 
 #include <algorithm>
 #include <functional>
@@ -51,7 +67,21 @@ Description:
 
 //Number of jacobi iterations to apply in order to
 // assure the constraints are solved. (Last tutorial)
-#define SOLVER_ITERATIONS 50
+// - The solver stops early once the largest change in relative velocity applied
+//   by any manifold/constraint in an iteration is below the tolerance (m/s)
+#define SOLVER_MIN_ITERATIONS 4
+#define SOLVER_MAX_ITERATIONS 20
+#define SOLVER_TOLERANCE 0.001f
+
+//The solver splits the manifolds and constraints into batches (colours) that don't share any dynamic
+// objects, so each batch can be solved in parallel
+#define SOLVER_MAX_COLOURS 64			//Colours are tracked as bitmasks, anything that doesn't fit is solved on one thread
+#define SOLVER_PARALLEL_MIN_ITEMS 128	//Smaller solves aren't worth the threading overhead
+
+//Bullets (see PhysicsNode::SetBullet) are moved from one impact to the next within a step, up to this many times
+#define CCD_MAX_SUBSTEPS 4
+//Bullets moving less than this many swept radii in a step can't pass through anything, so aren't swept
+#define CCD_MOTION_THRESHOLD 1.0f
 
 
 //Just saves including windows.h for the sake of defining true/false
@@ -69,6 +99,25 @@ Description:
 #define DEBUGDRAW_FLAGS_OCTREE					0x10
 #define DEBUGDRAW_FLAGS_BOUNDINGRADIUS			0x20
 
+//Broadphase collision detection methods
+enum BroadphaseMode
+{
+	BROADPHASE_BRUTEFORCE = 0,		//Every object against every other object
+	BROADPHASE_OCTREE,				//Persistent loose octree
+	BROADPHASE_SORTANDSWEEP,		//Sort and sweep along the x axis
+	BROADPHASE_AABBTREE,			//Dynamic bounding volume hierarchy
+	BROADPHASE_UNIFORMGRID,			//Uniform grid / spatial hash
+	BROADPHASE_MAX
+};
+
+//Narrowphase methods for pairs of shapes without a closed form test (see CollisionDispatch)
+enum NarrowphaseMode
+{
+	NARROWPHASE_SAT = 0,			//Separating axis test over every face normal and edge-edge axis
+	NARROWPHASE_GJK,				//GJK/EPA through the shapes' support functions
+	NARROWPHASE_MAX
+};
+
 class PhysicsEngine : public TSingleton<PhysicsEngine>
 {
 	friend class TSingleton < PhysicsEngine > ;
@@ -77,16 +126,43 @@ public:
 	void SetDefaults();
 
 	//Add/Remove Physics Objects
+	// - Objects added or removed from inside a collision callback are only added/removed once the update has
+	//   finished, so a node removed by a callback mustn't be deleted until then
 	void AddPhysicsObject(PhysicsNode* obj);
 	void RemovePhysicsObject(PhysicsNode* obj);
+
+	//Removes the object and deletes it
+	// - From inside a collision callback the delete is held back along with the removal, and the node is cut off
+	//   from its parent and callbacks for the rest of the update as whatever owned it is going away
+	void DeletePhysicsObject(PhysicsNode* obj);
 	void RemoveAllPhysicsObjects(); //Delete all physics entities etc and reset-physics environment for new scene to be initialized
 
 	//Add Constraints
 	void AddConstraint(Constraint* c) { constraints.push_back(c); }
+
+	//Add/Remove Cloths
+	// - Cloths are simulated on their own after the rigid bodies each update, and are deleted along with everything else
+	//   in RemoveAllPhysicsObjects
+	void AddCloth(Cloth* cloth) { cloths.push_back(cloth); }
+	void RemoveCloth(Cloth* cloth) { cloths.erase(std::remove(cloths.begin(), cloths.end(), cloth), cloths.end()); }
 	
 
 	//Update Physics Engine
 	void Update(float deltaTime);			//DeltaTime here is 'seconds' since last update not milliseconds
+
+	//Run the physics on its own thread, at a fixed rate of one update per timestep
+	// - Update() then only passes the transforms on to the GameObjects, interpolated between the last two physics
+	//   updates so the physics and render rates don't have to match
+	// - Anything that reads or changes the physics from the game thread (scene updates, adding/removing objects, Update(),
+	//   DebugRender() etc) must hold LockPhysics() while doing so. The renderer can run without it, as the RenderNodes
+	//   are only given their transforms from inside Update()
+	// - Collision callbacks are fired on the physics thread
+	// - Must not be called while holding LockPhysics()
+	void SetThreaded(bool threaded);
+	inline bool IsThreaded() const { return isThreaded; }
+
+	//Stops the physics thread starting another update until the lock is released
+	inline std::unique_lock<std::mutex> LockPhysics() { return std::unique_lock<std::mutex>(stepMutex); }
 	
 	//Debug draw all physics objects, manifolds and constraints
 	void DebugRender();
@@ -109,6 +185,10 @@ public:
 
 	inline float GetDeltaTime() const			{ return updateTimestep; }
 
+	inline void SetSolverIterations(unsigned int minIts, unsigned int maxIts) { solverMinIterations = minIts; solverMaxIterations = max(minIts, maxIts); }
+	inline void SetSolverTolerance(float tolerance) { solverTolerance = tolerance; }
+	inline float GetSolverTolerance() const		{ return solverTolerance; }
+
 	inline std::vector<CollisionPair> GetBroadphaseColPairs() { return broadphaseColPairs; }
 
 	void PrintPerformanceTimers(const Vector4& color)
@@ -117,15 +197,75 @@ public:
 		perfBroadphase.PrintOutputToStatusEntry(color,	"    Broadphase  :");
 		perfNarrowphase.PrintOutputToStatusEntry(color,	"    Narrowphase :");
 		perfSolver.PrintOutputToStatusEntry(color,		"    Solver      :");
+		perfCloth.PrintOutputToStatusEntry(color,		"    Cloth       :");
+		NCLDebug::AddStatusEntry(color, "    Solver Its  : %d [min:%d, max:%d]", solverIterations, solverMinIterations, solverMaxIterations);
+		NCLDebug::AddStatusEntry(color, "    Step Allocs : %d [%.1fKB, arena %.1fKB]", (int)GetNumStepAllocations(), GetStepAllocatedBytes() / 1024.0f, GetArenaCapacity() / 1024.0f);
+	}
+
+	//Per stage timers and counters, used to profile the engine without a window (see PhysicsBenchmark)
+	inline PerfTimer& GetIntegrationTimer()		{ return perfUpdate; }
+	inline PerfTimer& GetBroadphaseTimer()		{ return perfBroadphase; }
+	inline PerfTimer& GetNarrowphaseTimer()		{ return perfNarrowphase; }
+	inline PerfTimer& GetSolverTimer()			{ return perfSolver; }
+	inline PerfTimer& GetClothTimer()			{ return perfCloth; }
+
+	inline size_t GetNumPhysicsObjects() const	{ return physicsNodes.size(); }
+	inline size_t GetNumBroadphasePairs() const	{ return broadphaseColPairs.size(); }
+	inline size_t GetNumManifolds() const		{ return manifolds.size(); }
+	inline size_t GetNumSleepingObjects() const	{ return numSleepingNodes; }
+	inline unsigned int GetNumSolverIterations() const { return solverIterations; }
+
+	//Temporary allocations made from the frame arenas during the last update, and the total size of the arenas
+	inline size_t GetNumStepAllocations() const
+	{
+		size_t count = 0;
+		for (const FrameArena* arena : threadArenas) count += arena->GetNumAllocations();
+		return count;
+	}
+	inline size_t GetStepAllocatedBytes() const
+	{
+		size_t bytes = 0;
+		for (const FrameArena* arena : threadArenas) bytes += arena->GetBytesAllocated();
+		return bytes;
+	}
+	inline size_t GetArenaCapacity() const
+	{
+		size_t bytes = 0;
+		for (const FrameArena* arena : threadArenas) bytes += arena->GetCapacity();
+		return bytes;
 	}
 
 	inline Octree* GetOctree() const { return m_octree; }
 	inline const int GetNumSphereSphereChecks() const { return numSphereSphereChecks; }
 
+	//Switch broadphase method, building the new method's structures from the current physics objects
+	void SetBroadphaseMode(BroadphaseMode mode);
+	inline BroadphaseMode GetBroadphaseMode() const { return broadphaseMode; }
+	inline const char* GetBroadphaseModeName() const
+	{
+		switch (broadphaseMode)
+		{
+		case BROADPHASE_OCTREE:			return "Octree";
+		case BROADPHASE_SORTANDSWEEP:	return "Sort and Sweep";
+		case BROADPHASE_AABBTREE:		return "AABB Tree";
+		case BROADPHASE_UNIFORMGRID:	return "Uniform Grid";
+		default:						return "Brute Force";
+		}
+	}
+
+	inline void SetNarrowphaseMode(NarrowphaseMode mode) { narrowphaseMode = mode; }
+	inline NarrowphaseMode GetNarrowphaseMode() const { return narrowphaseMode; }
+	inline const char* GetNarrowphaseModeName() const
+	{
+		return (narrowphaseMode == NARROWPHASE_GJK) ? "GJK/EPA" : "SAT";
+	}
+
+	//Switches between the octree and brute force
 	void ToggleOctrees();
 	inline void ToggleSphereSphere() { useSphereSphere = !useSphereSphere; }
+	inline void SetSphereSphere(bool use) { useSphereSphere = use; }
 
-	inline const bool UsingOctrees() { return useOctrees; }
+	inline const bool UsingOctrees() { return broadphaseMode == BROADPHASE_OCTREE; }
 	inline const bool UsingSphereSphere() { return useSphereSphere; }
 
 protected:
@@ -135,8 +275,10 @@ protected:
 	//The actual time-independant update function
 	void UpdatePhysics();
 
+	//Runs UpdatePhysics once every timestep until SetThreaded(false) is called
+	void PhysicsThreadLoop();
+
 	//Handles broadphase collision detection
-	bool SweepSortFunc(PhysicsNode* nodeA, PhysicsNode* nodeB);
 	void BroadPhaseCollisions();
 
 	void SphereSphereCheck();
@@ -144,6 +286,55 @@ protected:
 	//Handles narrowphase collision detection
 	void NarrowPhaseCollisions();
 
+	//Marks the pair as touching this step, firing the enter callbacks if it wasn't touching before and
+	// the per-step callbacks every time
+	// - cached is the pair's entry in pairCache, which is added if it is NULL
+	// - Returns whether the collision should be responded to
+	struct CachedPair;
+	bool TouchPair(PhysicsNode* pnodeA, PhysicsNode* pnodeB, CachedPair*& cached);
+
+	//Fires the exit callbacks of any pairs that didn't touch this step, and frees their manifolds
+	void RemoveSeparatedPairs();
+
+	//Adds/removes/deletes the objects that collision callbacks asked to add/remove/delete during the last update
+	void ApplyPendingObjectChanges();
+
+	//Moves every awake bullet through the step, stopping it at the first thing its swept sphere touches and
+	// carrying on from there with its new velocity
+	void UpdateBullets();
+
+	//Finds every node whose AABB overlaps the given box, using the broadphase's structures if it can
+	void QueryBroadphase(const BoundingBox& bounds, std::vector<PhysicsNode*>& out_nodes);
+
+	//Applies the impulse for a single contact between a bullet and the node it has swept into
+	// - The offsets are from each node's position to the point of impact, and the normal points from the node to the bullet
+	void ResolveBulletImpact(PhysicsNode* bullet, PhysicsNode* other, const Vector3& relPosBullet, const Vector3& relPosOther, const Vector3& normal);
+
+	//Groups the nodes into islands joined by contacts and constraints, then puts each island to sleep
+	// or wakes it as a whole
+	void UpdateIslands();
+
+	//Union-find over islandParent, with path halving
+	inline unsigned int FindIsland(unsigned int idx)
+	{
+		while (islandParent[idx] != idx)
+		{
+			islandParent[idx] = islandParent[islandParent[idx]];
+			idx = islandParent[idx];
+		}
+		return idx;
+	}
+	void LinkIsland(PhysicsNode* pnodeA, PhysicsNode* pnodeB);
+
+	//Manifolds are recycled through a free list rather than going back to the heap when their pair stops colliding
+	// - AllocManifold is safe to call from the narrowphase threads
+	Manifold* AllocManifold();
+	void FreeManifold(Manifold* m);
+
+	//Greedy graph colouring of this step's manifolds and constraints into solverBatches
+	void ColourSolverBatches();
+	unsigned int PickSolverColour(PhysicsNode* pnodeA, PhysicsNode* pnodeB);
+
 	bool		isPaused;
 	float		updateTimestep, updateRealTimeAccum;
 	uint		debugDrawFlags;
@@ -151,28 +342,132 @@ protected:
 	Vector3		gravity;
 	float		dampingFactor;
 
+	//Physics thread (see SetThreaded)
+	bool									isThreaded = false;
+	std::thread								physicsThread;
+	std::atomic<bool>						physicsThreadRunning;
+	std::atomic<bool>						physicsThreadBehind;	//Set when the thread drops time, logged from the game thread
+	std::mutex								stepMutex;				//Held by the physics thread for each update, see LockPhysics
+	std::chrono::steady_clock::time_point	lastStepTime;
+
+	unsigned int	solverMinIterations, solverMaxIterations;
+	float			solverTolerance;
+	unsigned int	solverIterations = 0;		//Number of iterations used by the last update
+	std::vector<float> solverResiduals;			//Largest velocity change in each iteration of the last update
+
 
 	std::vector<CollisionPair>  broadphaseColPairs;
 
+	//Every pair that is touching is kept between steps, so the collision callbacks can tell when a pair
+	// starts and stops touching (see PhysicsNode::SetOnCollisionEnterCallback), and contacts can be warm started
+	// - Pairs between sleeping nodes are also kept, their manifolds join the sleeping nodes into islands
+	struct CachedPair
+	{
+		PhysicsNode*	nodeA;
+		PhysicsNode*	nodeB;
+		Manifold*		manifold;		//NULL if the pair isn't being responded to, or had no contacts last time it touched
+		unsigned int	lastStep;		//Last step the pair touched, it is removed if it misses a step while either node is awake
+		bool			respond;		//False if either enter callback dropped the collision
+	};
+	std::unordered_map<uint64_t, CachedPair> pairCache;		//Keyed by PairHashSet::PairKey
+
+	//Callbacks are fired part way through walking the pair cache and the node list, so objects added or removed
+	// by them are held here until the update has finished
+	bool						inPhysicsUpdate = false;
+	std::vector<PhysicsNode*>	pendingAdditions;
+	std::vector<PhysicsNode*>	pendingRemovals;
+	std::vector<PhysicsNode*>	pendingDeletions;
+	unsigned int physicsStep = 0;
+
+	std::vector<unsigned int>	islandParent;		//Union-find parent of each node, indexed by PhysicsNode::GetBodyIndex
+	std::vector<char>			islandAwake;		//Whether the island with the given root node has to stay awake
+	size_t						numSleepingNodes = 0;
+
+	//Manifolds and constraints that can be solved at the same time, no two share a dynamic object
+	struct SolverBatch
+	{
+		std::vector<Manifold*>		manifolds;
+		std::vector<Constraint*>	constraints;
+	};
+	SolverBatch					solverBatches[SOLVER_MAX_COLOURS + 1];	//The last batch holds anything that couldn't be coloured
+	unsigned int				numSolverColours = 0;
+	std::vector<uint64_t>		nodeColours;		//Colours used by each node's manifolds/constraints, indexed by PhysicsNode::GetBodyIndex
+	SolverBodies				solverBodies;		//Velocities, inverse masses and inverse inertias of every node while the solver runs
+
+	//Output of the narrowphase for a single colliding pair
+	struct NarrowphaseResult
+	{
+		CollisionPair	pair;
+		CollisionData	colData;
+		Manifold*		manifold;
+		CachedPair*		cached;			//NULL if the pair wasn't touching last step
+	};
+
+	//Colliding pairs found by each narrowphase thread, merged in order so the result is deterministic
+	std::vector<std::vector<NarrowphaseResult>> threadColResults;
+
+	//The axis that separated each pair tested with SAT or GJK last step, or the collision normal if they collided.
+	// It is tested first the next step, so pairs that stay apart are normally rejected with a single projection
+	// (SAT) or support point (GJK).
+	// - Entries are dropped as soon as the broadphase stops finding the pair
+	struct CachedPairAxis
+	{
+		Vector3			axis;
+		unsigned int	lastStep;
+	};
+	std::unordered_map<uint64_t, CachedPairAxis> pairAxisCache;		//Keyed by PairHashSet::PairKey
+
+	//Pairs tested for the first time by each narrowphase thread, added to the cache after the parallel section
+	struct NewPairAxis
+	{
+		uint64_t		key;
+		Vector3			axis;
+	};
+	std::vector<std::vector<NewPairAxis>> threadNewPairAxes;
+
+	//Temporary data for each narrowphase thread (contact clipping etc), emptied at the start of every update
+	std::vector<FrameArena*>	threadArenas;
+
+	std::vector<Manifold*>		freeManifolds;		//Manifolds not currently used by any pair, see AllocManifold
+
+	//Scratch lists for UpdateBullets, kept between updates to avoid reallocating
+	std::vector<PhysicsNode*>	bulletCandidates;	//Nodes near the current bullet's sweep
+	std::vector<PhysicsNode*>	bulletIgnored;		//Nodes the current bullet has hit this step whose callbacks dropped the collision
+
+	//Bounding sphere culling data for each broadphase pair, kept between updates to avoid reallocating
+	std::vector<float> sphereDX, sphereDY, sphereDZ;
+	std::vector<float> sphereRadius;
+
 	std::vector<PhysicsNode*>	physicsNodes;
 
 	std::vector<Constraint*>	constraints;		// Misc constraints applying to one or more physics objects e.g our DistanceConstraint
-	std::vector<Manifold*>		manifolds;			// Contact constraints between pairs of objects
+	std::vector<Constraint*>	activeConstraints;	// Constraints with at least one awake object, solved this step
+	std::vector<Manifold*>		manifolds;			// Contact constraints between pairs of objects being solved this step
+	std::vector<Cloth*>			cloths;
 
 	PerfTimer perfUpdate;
 	PerfTimer perfBroadphase;
 	PerfTimer perfNarrowphase;
 	PerfTimer perfSolver;
+	PerfTimer perfCloth;
 
 	inline void CreateOctree() { m_octree = new Octree(BoundingBox(octree_min, octree_max), physicsNodes); }
 
 	bool drawOctree = false;
-	Octree* m_octree;
+	Octree* m_octree = NULL;
 	const Vector3 octree_max = Vector3(64.0f, 58.0f, 64.0f);
 	const Vector3 octree_min = -Vector3(64.0f, 70.0f, 64.0f);
 
-	bool useOctrees = true;
+	SortAndSweep* m_sortAndSweep = NULL;
+	DynamicAABBTree* m_aabbTree = NULL;
+	UniformGrid* m_uniformGrid = NULL;
+
+	BroadphaseMode broadphaseMode = BROADPHASE_OCTREE;
+	NarrowphaseMode narrowphaseMode = NARROWPHASE_SAT;
 	bool useSphereSphere = true;
 
 	int numSphereSphereChecks = 0;
+
+	//Physics IDs are never reused so they can't be confused with a removed node
+	unsigned int nextPhysicsID = 1;
 };
\ No newline at end of file
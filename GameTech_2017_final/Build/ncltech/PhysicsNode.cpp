@@ -75,7 +75,12 @@ void PhysicsNode::IntegrateForPosition(float dt)
 	//Finally: Notify any listener's that this PhysicsNode has a new world transform.
 	// - This is used by GameObject to set the worldTransform of any RenderNode's. 
 	//   Please don't delete this!!!!!
-	FireOnUpdateCallback();
+	// - When the physics engine has its own thread the listeners are called from the game thread instead,
+	//   so only the world transform is updated here
+	if (PhysicsEngine::Instance()->IsThreaded())
+		UpdateWorldTransform();
+	else
+		FireOnUpdateCallback();
 }
 
 void PhysicsNode::DrawBoundingRadius()
@@ -110,55 +115,15 @@ void PhysicsNode::DrawBoundingRadius()
 	}
 }
 
-void PhysicsNode::UpdateVelocities()
+void PhysicsNode::UpdateSleepTimer(float dt)
 {
-	for (int i = 1; i < VELOCITY_FRAMES; ++i)
+	if (Vector3::Dot(linVelocity, linVelocity) > SLEEP_LINEAR_VELOCITY * SLEEP_LINEAR_VELOCITY
+		|| Vector3::Dot(angVelocity, angVelocity) > SLEEP_ANGULAR_VELOCITY * SLEEP_ANGULAR_VELOCITY)
 	{
-		linVelocities[i] = linVelocities[i - 1];
-		angVelocities[i] = angVelocities[i - 1];
-	}
-	linVelocities[0] = linVelocity;
-	angVelocities[0] = angVelocity;
-}
-
-void PhysicsNode::DetermineRestState()
-{
-	//Every 1 second wake up from rest
-	//This accounts for any error in rest calculation
-	//Sometimes objects will have another object moved from underneath it
-	//without a collision happening so the top object will think that
-	//it should still be at rest, when really it should start to fall.
-	//To fix this I occasionally stop all resting objects from resting
-	if (timeSinceRestCheck > 1.0f)
-	{
-		atRest = false;
+		sleepTimer = 0.0f;
 	}
 	else
 	{
-		//Whether the node moved in any of the previous frames
-		bool movement = false;
-		for (int i = 0; i < VELOCITY_FRAMES; ++i)
-		{
-			//If any of the previous frames velocities are greater than <small value> then the node is not at rest 
-			if (linVelocities[i].Length() > 0.05f || angVelocities[i].Length() > 0.01f)
-			{
-				movement = true;
-			}
-		}
-		atRest = movement ? false : true;
-	}
-
-	if (!atRest)
-	{
-		timeSinceRestCheck = 0.0f;
-	}
-}
-
-void PhysicsNode::ResetVelocities()
-{
-	for (int i = 0; i < VELOCITY_FRAMES; ++i)
-	{
-		linVelocities[i] = Vector3(10.0f, 10.0f, 10.0f);
-		angVelocities[i] = Vector3(10.0f, 10.0f, 10.0f);
+		sleepTimer += dt;
 	}
 }
@@ -29,14 +29,16 @@ Description:
 
 *//////////////////////////////////////////////////////////////////////////////
 
-#define VELOCITY_FRAMES 10		//Number of frames used to calculate rest state
-
 #pragma once
-#include <nclgl\Quaternion.h>
-#include <nclgl\Matrix3.h>
+#include <nclgl/Quaternion.h>
+#include <nclgl/Matrix3.h>
 #include "CollisionShape.h"
 #include <functional>
 
+#define SLEEP_LINEAR_VELOCITY 0.05f		//Nodes moving slower than this (and the angular velocity below) can sleep
+#define SLEEP_ANGULAR_VELOCITY 0.05f
+#define SLEEP_TIME 0.5f					//Time every node in an island has to be still for before the island sleeps
+
 struct CollisionPair	//Forms the output of the broadphase collision detection
 {
 	PhysicsNode* pObjectA;
@@ -56,6 +58,8 @@ struct CollisionPair	//Forms the output of the broadphase collision detection
 class PhysicsNode;
 
 //Callback function called whenever a collision is detected between two objects
+// - OnCollision is called every step the two objects are touching, OnCollisionEnter only on the
+//   first step they touch (see PhysicsNode::SetOnCollisionEnterCallback)
 //Params:
 //	PhysicsNode* this_obj			- The current object class that contains the callback
 //	PhysicsNode* colliding_obj	- The object that is colliding with the given object
@@ -65,6 +69,12 @@ class PhysicsNode;
 //			  > This can be useful for AI to see if a player/agent is inside an area/collision volume
 typedef std::function<bool(PhysicsNode* this_obj, PhysicsNode* colliding_obj)> PhysicsCollisionCallback;
 
+//Callback function called on the first step two objects that were touching stop touching
+//Params:
+//	PhysicsNode* this_obj			- The current object class that contains the callback
+//	PhysicsNode* colliding_obj	- The object that was colliding with the given object
+typedef std::function<void(PhysicsNode* this_obj, PhysicsNode* colliding_obj)> PhysicsCollisionExitCallback;
+
 
 //Callback function called whenever this physicsnode's world transform is updated
 //Params:
@@ -77,14 +87,16 @@ class PhysicsNode
 {
 public:
 	PhysicsNode()
-		: position(0.0f, 0.0f, 0.0f)
+		: parent(NULL)
+		, worldRotation(Matrix3::Identity)
+		, invWorldRotation(Matrix3::Identity)
+		, boundingRadius(0.0f)
+		, position(0.0f, 0.0f, 0.0f)
 		, linVelocity(0.0f, 0.0f, 0.0f)
-		, linVelocities{Vector3(10.0f, 10.0f, 10.0f)}
 		, force(0.0f, 0.0f, 0.0f)
 		, invMass(0.0f)
 		, orientation(0.0f, 0.0f, 0.0f, 1.0f)
 		, angVelocity(0.0f, 0.0f, 0.0f)
-		, angVelocities{ Vector3(10.0f, 10.0f, 10.0f) }
 		, torque(0.0f, 0.0f, 0.0f)
 		, invInertia(Matrix3::ZeroMatrix)
 		, collisionShape(NULL)
@@ -92,6 +104,7 @@ public:
 		, elasticity(0.9f)
 		, atRest(false)
 	{
+		ResetPublishedTransform();
 	}
 
 	virtual ~PhysicsNode()
@@ -106,8 +119,6 @@ public:
 	//<-- Between calling these two functions the physics engine will solve velocity to get 'true' final velocity -->
 	void IntegrateForPosition(float dt);
 
-	inline void UpdateRestTimer(float dt) { timeSinceRestCheck += dt; }
-
 	//<--------- GETTERS ------------->
 	inline GameObject*			GetParent()					const { return parent; }
 
@@ -127,12 +138,25 @@ public:
 	inline CollisionShape*		GetCollisionShape()			const { return collisionShape; }
 
 	inline const Matrix4&		GetWorldSpaceTransform()    const { return worldTransform; }
+	inline const Matrix3&		GetWorldSpaceRotation()		const { return worldRotation; }
+	inline const Matrix3&		GetInverseWorldSpaceRotation() const { return invWorldRotation; }
+
+	//Transform a world space point/direction into the node's local space
+	// - The world transform is rigid (rotation and translation only) so its inverse is just the transposed rotation,
+	//   which is cached along with the world transform
+	inline Vector3 WorldToLocalPoint(const Vector3& point) const { return invWorldRotation * (point - position); }
+	inline Vector3 WorldToLocalDirection(const Vector3& dir) const { return invWorldRotation * dir; }
 
 	inline const float			GetBoundingRadius()			const { return boundingRadius; }
+	inline const BoundingBox&	GetWorldSpaceAABB()			const { return worldAABB; }
 	inline const bool			GetAtRest()					const { return atRest; }
-	inline const float			GetTimeSinceRestCheck()		const { return timeSinceRestCheck; }
+	inline const float			GetSleepTimer()				const { return sleepTimer; }
+	inline unsigned int			GetBodyIndex()				const { return bodyIndex; }
 
-	inline const int			GetSoftBodyID()				const { return softBodyID; }
+	inline unsigned int			GetPhysicsID()				const { return physicsID; }
+
+	inline bool					IsBullet()					const { return isBullet; }
+	inline float				GetSweptRadius()			const { return sweptRadius; }
 
 
 	//<--------- SETTERS ------------->
@@ -141,12 +165,13 @@ public:
 	inline void SetElasticity(float elasticityCoeff)				{ elasticity = elasticityCoeff; }
 	inline void SetFriction(float frictionCoeff)					{ friction = frictionCoeff; }
 
-	inline void SetPosition(const Vector3& v)						{ position = v; FireOnUpdateCallback(); }
+	//Setting the position or orientation directly teleports the node, it isn't interpolated there by threaded physics
+	inline void SetPosition(const Vector3& v)						{ position = v; ResetPublishedTransform(); FireOnUpdateCallback(); }
 	inline void SetLinearVelocity(const Vector3& v)					{ linVelocity = v; }
 	inline void SetForce(const Vector3& v)							{ force = v; }
 	inline void SetInverseMass(const float& v)						{ invMass = v; }
 
-	inline void SetOrientation(const Quaternion& v)					{ orientation = v; FireOnUpdateCallback(); }
+	inline void SetOrientation(const Quaternion& v)					{ orientation = v; ResetPublishedTransform(); FireOnUpdateCallback(); }
 	inline void SetAngularVelocity(const Vector3& v)				{ angVelocity = v; }
 	inline void SetTorque(const Vector3& v)							{ torque = v; }
 	inline void SetInverseInertia(const Matrix3& v)					{ invInertia = v; }
@@ -156,74 +181,142 @@ public:
 		if (collisionShape) collisionShape->SetParent(NULL);
 		collisionShape = colShape;
 		if (collisionShape) collisionShape->SetParent(this);
+		UpdateWorldSpaceAABB();
 	}
 
 	inline void SetBoundingRadius(const float radius) { boundingRadius = radius; }
+
+	//Recompute the cached world space AABB, called whenever the world transform changes
+	// - Nodes without a collision shape fall back to a box around their bounding radius
+	inline void UpdateWorldSpaceAABB()
+	{
+		if (collisionShape)
+		{
+			worldAABB = collisionShape->BuildWorldSpaceAABB();
+		}
+		else
+		{
+			const Vector3 extents(boundingRadius, boundingRadius, boundingRadius);
+			worldAABB = BoundingBox(position - extents, position + extents);
+		}
+	}
 	inline void SetAtRest(const bool rest) { atRest = rest; }
-	inline void SetTimeSinceRestCheck(const float time) { timeSinceRestCheck = time; }
+	inline void SetBodyIndex(const unsigned int idx) { bodyIndex = idx; }
+
+	inline void SetPhysicsID(const unsigned int id) { physicsID = id; }
 
-	inline void SetSoftBodyID(const int id) { softBodyID = id; }
+	//Bullets are swept through each step rather than only being tested where they end up, so they can't pass
+	// through thin objects however fast they move (see ContinuousCollision)
+	// - The sweep uses a sphere of the given radius around the node's position, which should fit inside its
+	//   collision shape (the sphere's radius for a sphere, the smallest half dimension for a cuboid)
+	inline void SetBullet(const bool bullet, const float swept_radius) { isBullet = bullet; sweptRadius = swept_radius; }
 
 	//<---------- CALLBACKS ------------>
+	//Called every step this node is touching another (collision stay)
 	inline void SetOnCollisionCallback(PhysicsCollisionCallback callback) { onCollisionCallback = callback; }
 	inline bool FireOnCollisionEvent(PhysicsNode* obj_a, PhysicsNode* obj_b)
 	{
 		return (onCollisionCallback) ? onCollisionCallback(obj_a, obj_b) : true;
 	}
 
+	//Called once when this node starts touching another, and once when they stop
+	// - Returning false from the enter callback drops the collision for as long as the two stay touching,
+	//   so triggers don't need a callback every step
+	inline void SetOnCollisionEnterCallback(PhysicsCollisionCallback callback) { onCollisionEnterCallback = callback; }
+	inline bool FireOnCollisionEnterEvent(PhysicsNode* obj_a, PhysicsNode* obj_b)
+	{
+		return (onCollisionEnterCallback) ? onCollisionEnterCallback(obj_a, obj_b) : true;
+	}
+
+	inline void SetOnCollisionExitCallback(PhysicsCollisionExitCallback callback) { onCollisionExitCallback = callback; }
+	inline void FireOnCollisionExitEvent(PhysicsNode* obj_a, PhysicsNode* obj_b)
+	{
+		if (onCollisionExitCallback) onCollisionExitCallback(obj_a, obj_b);
+	}
+
 	inline void SetOnUpdateCallback(PhysicsUpdateCallback callback) { onUpdateCallback = callback; }
 	inline void FireOnUpdateCallback()
 	{
-		//Build world transform
-		worldTransform = orientation.ToMatrix4();
-		worldTransform.SetPositionVector(position);
+		UpdateWorldTransform();
 			
 		//Fire the OnUpdateCallback, notifying GameObject's and other potential
 		// listeners that this PhysicsNode has a new world transform.
 		if (onUpdateCallback) onUpdateCallback(worldTransform);
 	}
-	
-	void DrawBoundingRadius();
 
-	float GetMinX() { return minX; }
-	float GetMaxX() { return maxX; }
-	void SetMinX(float x) { minX = x; }
-	void SetMaxX(float x) { maxX = x; }
+	//Build world transform
+	inline void UpdateWorldTransform()
+	{
+		worldTransform = orientation.ToMatrix4();
+		worldTransform.SetPositionVector(position);
+
+		worldRotation = Matrix3(worldTransform);
+		invWorldRotation = Matrix3::Transpose(worldRotation);
 
-	float GetMinZ() { return minZ; }
-	float GetMaxZ() { return maxZ; }
-	void SetMinZ(float z) { minZ = z; }
-	void SetMaxZ(float z) { maxZ = z; }
+		UpdateWorldSpaceAABB();
+	}
 
-	//Update the velocity arrays for the previous frames
-	void UpdateVelocities();
-	//Determine the current rest state from the previous frame velocities
-	void DetermineRestState();
-	//Set the previous frame velocities to > 0 (used after dragging)
-	void ResetVelocities();
+	//<---------- THREADED PHYSICS ------------>
+	//When the physics engine runs on its own thread the listeners are passed a transform part way between the
+	// last two physics updates, so objects move smoothly however the render and physics rates line up.
+	// - PublishTransform is called by the physics thread after each update, the interpolated callback is fired
+	//   by the game thread each frame (see PhysicsEngine::SetThreaded)
+	inline void PublishTransform()
+	{
+		publishedPosition[0] = publishedPosition[1];
+		publishedOrientation[0] = publishedOrientation[1];
+		publishedPosition[1] = position;
+		publishedOrientation[1] = orientation;
+	}
+
+	//Forget the previous update, so a node that has been moved directly isn't interpolated from its old position
+	inline void ResetPublishedTransform()
+	{
+		publishedPosition[0] = publishedPosition[1] = position;
+		publishedOrientation[0] = publishedOrientation[1] = orientation;
+	}
+
+	//Alpha is how far through the current physics timestep the renderer is, from 0 to 1
+	inline void FireOnUpdateCallback(float alpha)
+	{
+		if (!onUpdateCallback) return;
+
+		Matrix4 transform = Quaternion::Slerp(publishedOrientation[0], publishedOrientation[1], alpha).ToMatrix4();
+		transform.SetPositionVector(publishedPosition[0] + (publishedPosition[1] - publishedPosition[0]) * alpha);
+		onUpdateCallback(transform);
+	}
+	
+	void DrawBoundingRadius();
+
+	//Add to the time the node has been still for, or reset it if the node is moving
+	void UpdateSleepTimer(float dt);
+	//Wake the node, its island is woken along with it on the next physics update (used after dragging)
+	inline void WakeUp() { atRest = false; sleepTimer = 0.0f; }
 
 protected:
 	//Useful parameters
 	GameObject*				parent;
 	Matrix4					worldTransform;
+	Matrix3					worldRotation;		//Rotation part of worldTransform
+	Matrix3					invWorldRotation;	//Transpose of worldRotation
 	PhysicsUpdateCallback	onUpdateCallback;
 	
 	float					boundingRadius;		//Bounding radius used for broadphase collision checks
+	BoundingBox				worldAABB;			//Tight world space AABB used by the broadphase, updated with worldTransform
+
+	Vector3					publishedPosition[2];		//State after the previous and latest physics updates, for threaded physics
+	Quaternion				publishedOrientation[2];
 
 //Added in Tutorial 2
 	//<---------LINEAR-------------->
 	Vector3		position;
 	Vector3		linVelocity;
-	//Track previous frame linVelocities for determining rest state - initialise to value > 0
-	Vector3		linVelocities[VELOCITY_FRAMES];		
 	Vector3		force;
 	float		invMass;
 
 	//<----------ANGULAR-------------->
 	Quaternion  orientation;
 	Vector3		angVelocity;
-	//Track previous frame angVelocities for determining rest state  - initialise to value > 0
-	Vector3		angVelocities[VELOCITY_FRAMES];
 	Vector3		torque;
 	Matrix3     invInertia;
 
@@ -232,6 +325,8 @@ protected:
 	//<----------COLLISION------------>
 	CollisionShape*				collisionShape;
 	PhysicsCollisionCallback	onCollisionCallback;
+	PhysicsCollisionCallback	onCollisionEnterCallback;
+	PhysicsCollisionExitCallback	onCollisionExitCallback;
 
 
 //Added in Tutorial 5
@@ -239,26 +334,36 @@ protected:
 	float				elasticity;		///Value from 0-1 definiing how much the object bounces off other objects
 	float				friction;		///Value from 0-1 defining how much the object can slide off other objects
 
-	float minX;
-	float maxX;
-	float minZ;
-	float maxZ;
-
+	//Set by the physics engine for every node in a sleeping island
+	//Sleeping nodes are not integrated and pairs of sleeping nodes are skipped by the broadphase
 	bool atRest;
 
-	//Track the time since the object was last checked to be at rest.
-	//Sometimes objects will have another object moved from underneath it
-	//without a collision happening so the top object will think that
-	//it should still be at rest, when really it should start to fall.
-	//To fix this I occasionally stop all resting objects from resting
-	float timeSinceRestCheck = 0.0f;
-
-	//Give each soft body an id
-	//All physics nodes in that body will also be given that id
-	//They can then be checked for the same id to prevent collisions
-	//between nodes in the same soft body
-	//To allow different soft bodies to collide with each other
-	//each soft body should have a unique id
-	//None soft bodies should just use NULL
-	int softBodyID = NULL;
-};
\ No newline at end of file
+	//Time the node has been moving slower than the sleep velocities
+	float sleepTimer = 0.0f;
+
+	//Index of the node in the physics engine's node list, set each update when building islands
+	// - Used to look the node up in the island and solver arrays
+	unsigned int bodyIndex = 0;
+
+	//Unique id given to the node by the physics engine when it is added
+	//Used to build order independent keys for pairs of nodes
+	//0 until the node has been added to the physics engine
+	unsigned int physicsID = 0;
+
+	//Set for fast moving objects that need continuous collision detection, see SetBullet
+	bool isBullet = false;
+	float sweptRadius = 0.0f;
+};
+
+//Returns true if the broadphase should pass the pair of nodes on to the narrowphase
+// - Pairs where both nodes are at rest don't need checking
+// - Both nodes need a collision shape
+inline bool IsBroadphasePair(const PhysicsNode* pnodeA, const PhysicsNode* pnodeB)
+{
+	if (pnodeA->GetAtRest() && pnodeB->GetAtRest())
+	{
+		return false;
+	}
+
+	return pnodeA->GetCollisionShape() != NULL && pnodeB->GetCollisionShape() != NULL;
+}
\ No newline at end of file
@@ -15,6 +15,8 @@ SoftBody::SoftBody(const std::string& name, const int nodesX, const int nodesY,
 	m_nodeRadius = m_nodeSeparation * 0.5f;
 	m_id = id;
 	m_texture = texture;
+	m_dragInvMass = 0.0f;
+	m_dragging = false;
 
 	GenerateBody();
 }
@@ -26,10 +28,10 @@ SoftBody::~SoftBody()
 
 void SoftBody::GenerateBody()
 {
-	//Create the physics nodes making up the soft body
-	GeneratePhysicsNodes();
-	//Create the contraints connecting the nodes together
-	GeneratePhysicsConstraints();
+	//Create the particles making up the soft body
+	GenerateParticles();
+	//Create the contraints connecting the particles together
+	GenerateConstraints();
 	//Create the mesh for the whole 
 	m_mesh = GenerateMesh();
 	m_mesh->SetTexture(m_texture);
@@ -44,24 +46,27 @@ void SoftBody::GenerateBody()
 	rnode->SetBoundingRadius(m_nodeRadius);
 	rnode->SetColorRecursive(Vector4(1.0f, 1.0f, 1.0f, 1.0f));
 
-	softObject = new GameObjectExtended(m_name, rnode, m_pnodes);
+	//The cloth is simulated by the physics engine, the game object only has to draw it
+	std::vector<PhysicsNode*> noPhysicsNodes;
+	softObject = new GameObjectExtended(m_name, rnode, noPhysicsNodes);
 
-	m_pnodes[0]->SetOnUpdateCallback(
-		std::bind(&SoftBody::UpdateMeshVertices,
-			this,
-			std::placeholders::_1));
+	m_cloth->SetOnUpdateCallback(std::bind(&SoftBody::UpdateMeshVertices, this));
+	PhysicsEngine::Instance()->AddCloth(m_cloth);
 
 	if (m_draggable)
 	{
 		ScreenPicker::Instance()->RegisterNodeForMouseCallback(
 			dummy, //Dummy is the rendernode that actually contains the drawable mesh
-			std::bind(&CommonUtils::DragableObjectCallback, softObject, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4)
+			std::bind(&SoftBody::DragCallback, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4)
 		);
 	}
 }
 
-void SoftBody::GeneratePhysicsNodes()
+void SoftBody::GenerateParticles()
 {
+	m_cloth = new Cloth(m_nodeRadius);
+	m_cloth->SetCollidable(m_collidable);
+
 	for (int x = 0; x < m_numNodesX; ++x)
 	{
 		for (int y = 0; y < m_numNodesY; ++y)
@@ -70,33 +75,16 @@ void SoftBody::GeneratePhysicsNodes()
 			position.x += x * m_nodeSeparation;
 			position.y += y * m_nodeSeparation;
 
-			PhysicsNode* pnode = new PhysicsNode();
-			pnode->SetPosition(position);
-			pnode->SetInverseMass(m_invNodeMass);
-			pnode->SetBoundingRadius(m_nodeRadius);
-			pnode->SetSoftBodyID(m_id);
-
-			if (!m_collidable)
-			{
-				pnode->SetInverseInertia(SphereCollisionShape(m_nodeRadius).BuildInverseInertia(m_invNodeMass));
-			}
-			else
-			{
-				CollisionShape* pColshape = new SphereCollisionShape(m_nodeRadius);
-				pnode->SetCollisionShape(pColshape);
-				pnode->SetInverseInertia(pColshape->BuildInverseInertia(m_invNodeMass));
-			}
-
-			m_pnodes.push_back(pnode);
+			m_cloth->AddParticle(position, m_invNodeMass);
 		}
 	}
 
 	//Top left and top right corners are stationary
-	m_pnodes[m_numNodesY - 1]->SetInverseMass(0.0f);
-	m_pnodes[m_pnodes.size() - 1]->SetInverseMass(0.0f);
+	m_cloth->SetInverseMass(m_numNodesY - 1, 0.0f);
+	m_cloth->SetInverseMass((unsigned int)m_cloth->GetNumParticles() - 1, 0.0f);
 }
 
-void SoftBody::GeneratePhysicsConstraints()
+void SoftBody::GenerateConstraints()
 {
 	/*
 	 * 5 possible constraint cases
@@ -175,18 +163,18 @@ Mesh* SoftBody::GenerateMesh()
 	{
 		for (int y = 0; y < m_numNodesY - 1; ++y)
 		{
-			PhysicsNode* pnodeCurrent = m_pnodes[x * m_numNodesY + y];
+			const Vector3& current = m_cloth->GetPosition(GetCurrent(x, y));
 			int vertexIndex = (x * m_numNodesY + y) * 6;
 
 			//Bottom triangle
-			m->vertices[vertexIndex] = (pnodeCurrent->GetPosition() - m_position) * invNodeRadius;
-			m->vertices[vertexIndex + 1] = (GetRight(x, y)->GetPosition() - m_position) * invNodeRadius;
-			m->vertices[vertexIndex + 2] = (GetUp(x, y)->GetPosition() - m_position) * invNodeRadius;
+			m->vertices[vertexIndex] = (current - m_position) * invNodeRadius;
+			m->vertices[vertexIndex + 1] = (m_cloth->GetPosition(GetRight(x, y)) - m_position) * invNodeRadius;
+			m->vertices[vertexIndex + 2] = (m_cloth->GetPosition(GetUp(x, y)) - m_position) * invNodeRadius;
 
 			//Top triangle
-			m->vertices[vertexIndex + 3] = (GetRight(x, y)->GetPosition() - m_position) * invNodeRadius;
-			m->vertices[vertexIndex + 4] = (GetRightUp(x, y)->GetPosition() - m_position) * invNodeRadius;
-			m->vertices[vertexIndex + 5] = (GetUp(x, y)->GetPosition() - m_position) * invNodeRadius;
+			m->vertices[vertexIndex + 3] = (m_cloth->GetPosition(GetRight(x, y)) - m_position) * invNodeRadius;
+			m->vertices[vertexIndex + 4] = (m_cloth->GetPosition(GetRightUp(x, y)) - m_position) * invNodeRadius;
+			m->vertices[vertexIndex + 5] = (m_cloth->GetPosition(GetUp(x, y)) - m_position) * invNodeRadius;
 			
 			m->textureCoords[vertexIndex] = Vector2(x * texConstX, 1 - (y * texConstY));
 			m->textureCoords[vertexIndex + 1] = Vector2((x + 1) * texConstX, 1 - (y * texConstY));
@@ -209,7 +197,7 @@ Mesh* SoftBody::GenerateMesh()
 	return m;
 }
 
-void SoftBody::UpdateMeshVertices(const Matrix4& mat4)
+void SoftBody::UpdateMeshVertices()
 {
 	float invNodeRadius = 1.0f / m_nodeRadius;
 
@@ -217,18 +205,18 @@ void SoftBody::UpdateMeshVertices(const Matrix4& mat4)
 	{
 		for (int y = 0; y < m_numNodesY - 1; ++y)
 		{
-			PhysicsNode* pnodeCurrent = m_pnodes[x * m_numNodesY + y];
+			const Vector3& current = m_cloth->GetPosition(GetCurrent(x, y));
 			int vertexIndex = (x * m_numNodesY + y) * 6;
 
 			//Bottom triangle
-			m_mesh->vertices[vertexIndex] = (pnodeCurrent->GetPosition() - m_position) * invNodeRadius;
-			m_mesh->vertices[vertexIndex + 1] = (GetRight(x, y)->GetPosition() - m_position) * invNodeRadius;
-			m_mesh->vertices[vertexIndex + 2] = (GetUp(x, y)->GetPosition() - m_position) * invNodeRadius;
+			m_mesh->vertices[vertexIndex] = (current - m_position) * invNodeRadius;
+			m_mesh->vertices[vertexIndex + 1] = (m_cloth->GetPosition(GetRight(x, y)) - m_position) * invNodeRadius;
+			m_mesh->vertices[vertexIndex + 2] = (m_cloth->GetPosition(GetUp(x, y)) - m_position) * invNodeRadius;
 
 			//Top triangle
-			m_mesh->vertices[vertexIndex + 3] = (GetRight(x, y)->GetPosition() - m_position) * invNodeRadius;
-			m_mesh->vertices[vertexIndex + 4] = (GetRightUp(x, y)->GetPosition() - m_position) * invNodeRadius;
-			m_mesh->vertices[vertexIndex + 5] = (GetUp(x, y)->GetPosition() - m_position) * invNodeRadius;
+			m_mesh->vertices[vertexIndex + 3] = (m_cloth->GetPosition(GetRight(x, y)) - m_position) * invNodeRadius;
+			m_mesh->vertices[vertexIndex + 4] = (m_cloth->GetPosition(GetRightUp(x, y)) - m_position) * invNodeRadius;
+			m_mesh->vertices[vertexIndex + 5] = (m_cloth->GetPosition(GetUp(x, y)) - m_position) * invNodeRadius;
 		}
 	}
 
@@ -238,51 +226,42 @@ void SoftBody::UpdateMeshVertices(const Matrix4& mat4)
 	m_mesh->BufferData();
 }
 
+void SoftBody::DragCallback(float dt, const Vector3& newWsPos, const Vector3& wsMovedAmount, bool stopDragging)
+{
+	//The first particle is held still while it's dragged, the rest of the cloth follows it through the constraints
+	if (!m_dragging)
+	{
+		m_dragging = true;
+		m_dragInvMass = m_cloth->GetInverseMass(0);
+		m_cloth->SetInverseMass(0, 0.0f);
+	}
+
+	m_cloth->SetPosition(0, m_cloth->GetPosition(0) + wsMovedAmount);
+
+	if (stopDragging)
+	{
+		m_dragging = false;
+		m_cloth->SetInverseMass(0, m_dragInvMass);
+		m_cloth->SetVelocity(0, wsMovedAmount / dt);
+	}
+}
+
 void SoftBody::ConnectRight(const int x, const int y)
 {
-	PhysicsNode* connectFrom = m_pnodes[x * m_numNodesY + y];
-	PhysicsNode* connectTo = GetRight(x, y);		//pnode directly to the right
-
-	PhysicsEngine::Instance()->AddConstraint(new SpringConstraint(
-		connectFrom,								//Current pnode									
-		connectTo,
-		connectFrom->GetPosition(),
-		connectTo->GetPosition()));
+	m_cloth->AddDistanceConstraint(GetCurrent(x, y), GetRight(x, y), SOFTBODY_STRUCTURAL_COMPLIANCE);
 }
 
 void SoftBody::ConnectUp(const int x, const int y)
 {
-	PhysicsNode* connectFrom = m_pnodes[x * m_numNodesY + y];
-	PhysicsNode* connectTo = GetUp(x, y);			//pnode directly up
-	
-	PhysicsEngine::Instance()->AddConstraint(new SpringConstraint(
-		connectFrom,
-		connectTo,
-		connectFrom->GetPosition(),
-		connectTo->GetPosition()));
+	m_cloth->AddDistanceConstraint(GetCurrent(x, y), GetUp(x, y), SOFTBODY_STRUCTURAL_COMPLIANCE);
 }
 
 void SoftBody::ConnectRightUp(const int x, const int y)
 {
-	PhysicsNode* connectFrom = m_pnodes[x * m_numNodesY + y];
-	PhysicsNode* connectTo = GetRightUp(x, y);		//pnode right and up
-	
-	PhysicsEngine::Instance()->AddConstraint(new SpringConstraint(
-		connectFrom,
-		connectTo,
-		connectFrom->GetPosition(),
-		connectTo->GetPosition()));
+	m_cloth->AddDistanceConstraint(GetCurrent(x, y), GetRightUp(x, y), SOFTBODY_SHEAR_COMPLIANCE);
 }
 
 void SoftBody::ConnectLeftUp(const int x, const int y)
 {
-	PhysicsNode* connectFrom = m_pnodes[x * m_numNodesY + y];
-	PhysicsNode* connectTo = GetLeftUp(x, y);		//pnode left and up
-	
-	PhysicsEngine::Instance()->AddConstraint(new SpringConstraint(
-		connectFrom,
-		connectTo,
-		connectFrom->GetPosition(),
-		connectTo->GetPosition()));
+	m_cloth->AddDistanceConstraint(GetCurrent(x, y), GetLeftUp(x, y), SOFTBODY_SHEAR_COMPLIANCE);
 }
-
@@ -2,11 +2,15 @@
 
 #include "GameObjectExtended.h"
 #include "CommonUtils.h"
-#include "SphereCollisionShape.h"
-#include "DistanceConstraint.h"
-#include "SpringConstraint.h"
+#include "Cloth.h"
 #include "ScreenPicker.h"
 
+//Compliance (inverse stiffness, m/N) of the links along the grid and across its diagonals
+#define SOFTBODY_STRUCTURAL_COMPLIANCE 0.0f
+#define SOFTBODY_SHEAR_COMPLIANCE 0.001f
+
+//A rectangular sheet of cloth, simulated by the physics engine as a Cloth of nodesX * nodesY particles
+// - The game object only holds the render node, the particles are not PhysicsNodes
 class SoftBody
 {
 public:
@@ -17,12 +21,13 @@ public:
 	~SoftBody();
 
 	void GenerateBody();
-	void GeneratePhysicsNodes();
-	void GeneratePhysicsConstraints();
+	void GenerateParticles();
+	void GenerateConstraints();
 	Mesh* GenerateMesh();
 
 
 	inline GameObjectExtended* SoftObject() { return softObject; }
+	inline Cloth* GetCloth() { return m_cloth; }
 
 protected:
 	std::string m_name;
@@ -36,14 +41,21 @@ protected:
 	float m_nodeRadius;
 	int m_id;
 
-	std::vector<PhysicsNode*> m_pnodes;
+	Cloth* m_cloth;
 	Mesh* m_mesh;
 	GLuint m_texture;
 	GameObjectExtended* softObject;
 
-	void UpdateMeshVertices(const Matrix4& mat4);
+	//Inverse mass of the particle being dragged, which is pinned while it is held
+	float m_dragInvMass;
+	bool m_dragging;
+
+	void UpdateMeshVertices();
+
+	//Moves the first particle with the mouse
+	void DragCallback(float dt, const Vector3& newWsPos, const Vector3& wsMovedAmount, bool stopDragging);
 	
-	//Create a spring constraint between the current node and the node 
+	//Create a distance constraint between the current node and the node 
 	//in the direction specified
 	//Pass in the x and y index of the current node
 	void ConnectRight(const int x, const int y);
@@ -51,10 +63,11 @@ protected:
 	void ConnectRightUp(const int x, const int y);
 	void ConnectLeftUp(const int x, const int y);
 
-	//Get physics node relative to the node indexes passed in
-	inline PhysicsNode* GetRight(const int x, const int y)		{ return m_pnodes[(x + 1) * m_numNodesY + y]; }
-	inline PhysicsNode* GetUp(const int x, const int y)			{ return m_pnodes[ x      * m_numNodesY + y + 1]; }
-	inline PhysicsNode* GetRightUp(const int x, const int y)	{ return m_pnodes[(x + 1) * m_numNodesY + y + 1]; }
-	inline PhysicsNode* GetLeftUp(const int x, const int y)		{ return m_pnodes[(x - 1) * m_numNodesY + y + 1]; }
+	//Get the index of the particle relative to the node indexes passed in
+	inline unsigned int GetCurrent(const int x, const int y)	{ return  x      * m_numNodesY + y; }
+	inline unsigned int GetRight(const int x, const int y)		{ return (x + 1) * m_numNodesY + y; }
+	inline unsigned int GetUp(const int x, const int y)			{ return  x      * m_numNodesY + y + 1; }
+	inline unsigned int GetRightUp(const int x, const int y)	{ return (x + 1) * m_numNodesY + y + 1; }
+	inline unsigned int GetLeftUp(const int x, const int y)		{ return (x - 1) * m_numNodesY + y + 1; }
 };
 
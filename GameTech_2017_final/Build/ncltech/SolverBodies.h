@@ -0,0 +1,85 @@
+#pragma once
+
+#include "PhysicsNode.h"
+#include <nclgl/Vector3.h>
+#include <nclgl/Matrix3.h>
+#include <vector>
+
+//Velocity state of every physics node for the constraint solver
+//
+//The PhysicsNodes are large heap allocated objects, so rather than going through their getters and setters for
+//every impulse the solver gathers the few values it needs into contiguous arrays indexed by the node's body index
+//(PhysicsNode::GetBodyIndex), solves on those and scatters the final velocities back once at the end.
+//
+//Static nodes (zero inverse mass) are never written to, as the parallel solver shares them between batches.
+
+class SolverBodies
+{
+public:
+	//Copy the velocities, inverse masses and inverse inertias out of the nodes
+	// - The nodes' body indices must match their positions in the list
+	void Gather(const std::vector<PhysicsNode*>& nodes)
+	{
+		const size_t numBodies = nodes.size();
+		linVelocity.resize(numBodies);
+		angVelocity.resize(numBodies);
+		invMass.resize(numBodies);
+		invInertia.resize(numBodies);
+
+		for (size_t i = 0; i < numBodies; ++i)
+		{
+			const PhysicsNode* pnode = nodes[i];
+			linVelocity[i] = pnode->GetLinearVelocity();
+			angVelocity[i] = pnode->GetAngularVelocity();
+			invMass[i] = pnode->GetInverseMass();
+			invInertia[i] = pnode->GetInverseInertia();
+		}
+	}
+
+	//Write the solved velocities back to the nodes
+	void Scatter(const std::vector<PhysicsNode*>& nodes) const
+	{
+		for (size_t i = 0; i < nodes.size(); ++i)
+		{
+			if (invMass[i] > 0.0f)
+			{
+				nodes[i]->SetLinearVelocity(linVelocity[i]);
+				nodes[i]->SetAngularVelocity(angVelocity[i]);
+			}
+		}
+	}
+
+	//Velocity of the point at the given offset from the body's centre of mass
+	inline Vector3 GetVelocityAt(unsigned int body, const Vector3& relPos) const
+	{
+		return linVelocity[body] + Vector3::Cross(angVelocity[body], relPos);
+	}
+
+	//Apply a velocity impulse at the given offset from the body's centre of mass
+	inline void ApplyImpulse(unsigned int body, const Vector3& impulse, const Vector3& relPos)
+	{
+		if (invMass[body] > 0.0f)
+		{
+			linVelocity[body] += impulse * invMass[body];
+			angVelocity[body] += invInertia[body] * Vector3::Cross(relPos, impulse);
+		}
+	}
+
+	//Inverse of the effective mass of the two bodies at the given points along the given axis
+	inline float ComputeConstraintMass(unsigned int bodyA, unsigned int bodyB, const Vector3& r1, const Vector3& r2, const Vector3& axis) const
+	{
+		return (invMass[bodyA] + invMass[bodyB]) +
+			Vector3::Dot(axis,
+				Vector3::Cross(invInertia[bodyA] * Vector3::Cross(r1, axis), r1) +
+				Vector3::Cross(invInertia[bodyB] * Vector3::Cross(r2, axis), r2));
+	}
+
+	inline const Vector3& GetLinearVelocity(unsigned int body) const { return linVelocity[body]; }
+	inline const Vector3& GetAngularVelocity(unsigned int body) const { return angVelocity[body]; }
+
+protected:
+	std::vector<Vector3>	linVelocity;
+	std::vector<Vector3>	angVelocity;
+	std::vector<float>		invMass;
+	std::vector<Matrix3>	invInertia;
+};
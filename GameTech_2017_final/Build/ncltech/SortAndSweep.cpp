@@ -0,0 +1,161 @@
+#include "SortAndSweep.h"
+
+SortAndSweep::SortAndSweep()
+{
+}
+
+SortAndSweep::SortAndSweep(std::vector<PhysicsNode*>& pNodes)
+{
+	for (PhysicsNode* pNode : pNodes)
+	{
+		InsertObject(pNode);
+	}
+}
+
+SortAndSweep::~SortAndSweep()
+{
+	Clear();
+}
+
+void SortAndSweep::InsertObject(PhysicsNode* pNode)
+{
+	//Already added
+	if (m_proxyLookup.find(pNode) != m_proxyLookup.end())
+	{
+		return;
+	}
+
+	unsigned int idx = (unsigned int)m_proxies.size();
+	m_proxyLookup[pNode] = idx;
+
+	Proxy proxy;
+	proxy.pNode = pNode;
+	proxy.bounds = pNode->GetWorldSpaceAABB();
+	proxy.activeIndex = -1;
+	m_proxies.push_back(proxy);
+
+	//Add the endpoints to the end of the array, they will be moved into place by the next sort
+	Endpoint minEnd = { proxy.bounds._min.x, idx, true };
+	Endpoint maxEnd = { proxy.bounds._max.x, idx, false };
+	m_endpoints.push_back(minEnd);
+	m_endpoints.push_back(maxEnd);
+}
+
+void SortAndSweep::RemoveObject(PhysicsNode* pNode)
+{
+	auto found = m_proxyLookup.find(pNode);
+	if (found == m_proxyLookup.end())
+	{
+		return;
+	}
+
+	unsigned int idx = found->second;
+	unsigned int last = (unsigned int)m_proxies.size() - 1;
+	m_proxyLookup.erase(found);
+
+	//Remove the node's endpoints, keeping the rest in order
+	//The last proxy is moved into the removed proxy's slot so its endpoints need updating
+	size_t j = 0;
+	for (size_t i = 0; i < m_endpoints.size(); ++i)
+	{
+		if (m_endpoints[i].proxy == idx)
+		{
+			continue;
+		}
+
+		m_endpoints[j] = m_endpoints[i];
+		if (m_endpoints[j].proxy == last)
+		{
+			m_endpoints[j].proxy = idx;
+		}
+		++j;
+	}
+	m_endpoints.resize(j);
+
+	if (idx != last)
+	{
+		m_proxies[idx] = m_proxies[last];
+		m_proxyLookup[m_proxies[idx].pNode] = idx;
+	}
+	m_proxies.pop_back();
+}
+
+void SortAndSweep::Clear()
+{
+	m_proxies.clear();
+	m_endpoints.clear();
+	m_proxyLookup.clear();
+	m_active.clear();
+}
+
+void SortAndSweep::UpdateObjects()
+{
+	m_numSwaps = 0;
+
+	//Refresh the bounds and endpoint values
+	for (Proxy& proxy : m_proxies)
+	{
+		proxy.bounds = proxy.pNode->GetWorldSpaceAABB();
+	}
+
+	for (Endpoint& endpoint : m_endpoints)
+	{
+		const BoundingBox& bounds = m_proxies[endpoint.proxy].bounds;
+		endpoint.value = endpoint.isMin ? bounds._min.x : bounds._max.x;
+	}
+
+	//Insertion sort
+	//The endpoints are sorted from the previous update so very few will need to move
+	for (size_t i = 1; i < m_endpoints.size(); ++i)
+	{
+		Endpoint endpoint = m_endpoints[i];
+		size_t j = i;
+		while (j > 0 && m_endpoints[j - 1].value > endpoint.value)
+		{
+			m_endpoints[j] = m_endpoints[j - 1];
+			--j;
+			++m_numSwaps;
+		}
+		m_endpoints[j] = endpoint;
+	}
+}
+
+void SortAndSweep::GenPairs(std::vector<CollisionPair>& colPairs)
+{
+	m_active.clear();
+
+	for (const Endpoint& endpoint : m_endpoints)
+	{
+		Proxy& proxyA = m_proxies[endpoint.proxy];
+
+		if (endpoint.isMin)
+		{
+			//Every active node overlaps this one on the x axis so only the other two axes need checking
+			for (unsigned int activeIdx : m_active)
+			{
+				const Proxy& proxyB = m_proxies[activeIdx];
+
+				if (proxyA.bounds.Intersects(proxyB.bounds)
+					&& IsBroadphasePair(proxyA.pNode, proxyB.pNode))
+				{
+					CollisionPair cp;
+					cp.pObjectA = proxyA.pNode;
+					cp.pObjectB = proxyB.pNode;
+					colPairs.push_back(cp);
+				}
+			}
+
+			proxyA.activeIndex = (int)m_active.size();
+			m_active.push_back(endpoint.proxy);
+		}
+		else
+		{
+			//Swap and pop the node from the active list
+			unsigned int moved = m_active.back();
+			m_active[proxyA.activeIndex] = moved;
+			m_proxies[moved].activeIndex = proxyA.activeIndex;
+			m_active.pop_back();
+			proxyA.activeIndex = -1;
+		}
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "PhysicsNode.h"
+#include "BoundingBox.h"
+#include <vector>
+#include <unordered_map>
+
+//Sort and sweep (sweep and prune) broadphase
+//
+//Each physics node has a min and max endpoint along the x axis. The endpoints are kept in a single
+//sorted array between physics updates, so each update only the endpoint values are refreshed and the
+//array is re-sorted with an insertion sort. Objects only move a small distance each update so the array
+//is almost sorted already and the sort is close to O(n).
+//
+//The sorted array is then swept from start to finish keeping a list of the 'active' nodes whose min
+//endpoint has been passed but not their max endpoint. Each node is only checked against the active
+//nodes, which are the only nodes it can overlap on the sweep axis.
+
+class SortAndSweep
+{
+public:
+	SortAndSweep();
+	SortAndSweep(std::vector<PhysicsNode*>& pNodes);
+	~SortAndSweep();
+
+	//Add/remove a single node
+	void InsertObject(PhysicsNode* pNode);
+	void RemoveObject(PhysicsNode* pNode);
+	void Clear();
+
+	//Refresh each node's bounds and re-sort the endpoints
+	void UpdateObjects();
+
+	//Sweep the sorted endpoints to find all the overlapping pairs
+	void GenPairs(std::vector<CollisionPair>& colPairs);
+
+	//Number of endpoint swaps made by the insertion sort during the last update
+	inline int GetNumSwaps() const { return m_numSwaps; }
+
+protected:
+	struct Endpoint
+	{
+		float			value;
+		unsigned int	proxy;		//Index of the node's proxy
+		bool			isMin;
+	};
+
+	struct Proxy
+	{
+		PhysicsNode*	pNode;
+		BoundingBox		bounds;
+		int				activeIndex;	//Position in the active list during the sweep, or -1
+	};
+
+	std::vector<Proxy> m_proxies;
+	std::vector<Endpoint> m_endpoints;						//Sorted by value along the x axis
+	std::unordered_map<PhysicsNode*, unsigned int> m_proxyLookup;
+
+	std::vector<unsigned int> m_active;						//Kept between updates so it doesn't need reallocating
+
+	int m_numSwaps = 0;
+};
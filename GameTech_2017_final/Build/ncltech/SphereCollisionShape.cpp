@@ -1,8 +1,8 @@
 #include "SphereCollisionShape.h"
 #include "PhysicsNode.h"
-#include <nclgl\NCLDebug.h>
-#include <nclgl\Matrix3.h>
-#include <nclgl\Vector3.h>
+#include <nclgl/NCLDebug.h>
+#include <nclgl/Matrix3.h>
+#include <nclgl/Vector3.h>
 
 
 SphereCollisionShape::SphereCollisionShape()
@@ -34,9 +34,16 @@ Matrix3 SphereCollisionShape::BuildInverseInertia(float invMass) const
 	return inertia;
 }
 
+BoundingBox SphereCollisionShape::BuildWorldSpaceAABB() const
+{
+	const Vector3& pos = Parent()->GetPosition();
+	const Vector3 extents(m_Radius, m_Radius, m_Radius);
+	return BoundingBox(pos - extents, pos + extents);
+}
+
 
 //TUTORIAL 4 CODE
-void SphereCollisionShape::GetCollisionAxes(const PhysicsNode* otherObject, std::vector<Vector3>& out_axes) const
+void SphereCollisionShape::GetCollisionAxes(const PhysicsNode* otherObject, CollisionAxes& out_axes) const
 {
 	/* There are infinite possible axes on a sphere so we MUST handle it seperately
 		- Luckily we can just get the closest point on the opposite object to our centre and use that.
@@ -46,7 +53,7 @@ void SphereCollisionShape::GetCollisionAxes(const PhysicsNode* otherObject, std:
 	Vector3 p1 = Parent()->GetPosition();
 	Vector3 p2 = otherObject->GetCollisionShape()->GetClosestPoint(p1);
 
-	out_axes.push_back((p1 - p2).Normalise());
+	out_axes.Add((p1 - p2).Normalise());
 }
 
 Vector3 SphereCollisionShape::GetClosestPoint(const Vector3& point) const
@@ -55,6 +62,16 @@ Vector3 SphereCollisionShape::GetClosestPoint(const Vector3& point) const
 	return Parent()->GetPosition() + diff * m_Radius;
 }
 
+Vector3 SphereCollisionShape::GetSupportPoint(const Vector3& dir) const
+{
+	const float length = dir.Length();
+	if (length < 1e-6f)
+	{
+		return Parent()->GetPosition();
+	}
+	return Parent()->GetPosition() + dir * (m_Radius / length);
+}
+
 void SphereCollisionShape::GetMinMaxVertexOnAxis(
 	const Vector3& axis,
 	Vector3& out_min,
@@ -68,9 +85,9 @@ void SphereCollisionShape::GetMinMaxVertexOnAxis(
 
 void SphereCollisionShape::GetIncidentReferencePolygon(
 	const Vector3& axis,
-	std::list<Vector3>& out_face,
+	ArenaList<Vector3>& out_face,
 	Vector3& out_normal,
-	std::vector<Plane>& out_adjacent_planes) const
+	ArenaVector<Plane>& out_adjacent_planes) const
 {
 	//This is used in Tutorial 5
 	out_face.push_back(Parent()->GetPosition() + axis * m_Radius);
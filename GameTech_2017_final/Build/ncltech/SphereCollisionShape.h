@@ -28,6 +28,8 @@ public:
 	SphereCollisionShape(float radius);
 	virtual ~SphereCollisionShape();
 
+	virtual CollisionShapeType GetType() const override { return COLLISION_SHAPE_SPHERE; }
+
 
 	// Get/Set Sphere Radius
 	void	SetRadius(float radius) { m_Radius = radius; }
@@ -39,15 +41,20 @@ public:
 	// Build Inertia Matrix for rotational mass
 	virtual Matrix3 BuildInverseInertia(float invMass) const override;
 
+	// Build world space AABB for the broadphase
+	virtual BoundingBox BuildWorldSpaceAABB() const override;
+
 
 	// Generic Collision Detection Routines
 	//  - Used in CollisionDetectionSAT to identify if two shapes overlap
 	virtual void GetCollisionAxes(
 		const PhysicsNode* otherObject,
-		std::vector<Vector3>& out_axes) const override;
+		CollisionAxes& out_axes) const override;
 
 	virtual Vector3 GetClosestPoint(const Vector3& point) const override;
 
+	virtual Vector3 GetSupportPoint(const Vector3& dir) const override;
+
 	virtual void GetMinMaxVertexOnAxis(
 		const Vector3& axis,
 		Vector3& out_min,
@@ -55,9 +62,9 @@ public:
 	
 	virtual void GetIncidentReferencePolygon(
 		const Vector3& axis,
-		std::list<Vector3>& out_face,
+		ArenaList<Vector3>& out_face,
 		Vector3& out_normal,
-		std::vector<Plane>& out_adjacent_planes) const override;
+		ArenaVector<Plane>& out_adjacent_planes) const override;
 
 protected:
 	float	m_Radius;
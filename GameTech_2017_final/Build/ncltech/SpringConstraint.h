@@ -2,7 +2,7 @@
 
 #include "Constraint.h"
 #include "PhysicsEngine.h"
-#include <nclgl\NCLDebug.h>
+#include <nclgl/NCLDebug.h>
 
 class SpringConstraint : public Constraint
 {
@@ -29,15 +29,18 @@ public:
 		relPosB = Matrix3::Transpose(pnodeB->GetOrientation().ToMatrix3()) * r2;
 	}
 
-	//Solves the constraint and applies a velocity impulse to the two
-	// objects in order to satisfy the constraint.
-	virtual void ApplyImpulse() override
+	//Computes the constraint's direction, mass and spring term once per step
+	// - The objects only move after the solver has finished, so these don't change while it iterates
+	virtual void PreSolverStep(float dt) override
 	{
+		bodyA = pnodeA->GetBodyIndex();
+		bodyB = pnodeB->GetBodyIndex();
+
 		//Compute current constraint vars based on object A/B's
 		//position/rotation
 
-		Vector3 r1 = pnodeA->GetOrientation().ToMatrix3() * relPosA;
-		Vector3 r2 = pnodeB->GetOrientation().ToMatrix3() * relPosB;
+		r1 = pnodeA->GetOrientation().ToMatrix3() * relPosA;
+		r2 = pnodeB->GetOrientation().ToMatrix3() * relPosB;
 
 		//Get the global contact points in world space
 
@@ -47,21 +50,10 @@ public:
 		//Get the vector between the two contact points
 
 		Vector3 ab = globalOnB - globalOnA;
-		Vector3 abn = ab;
+		abn = ab;
 
 		abn.Normalise();
 
-		//Compute the velocity of objects A and B at the point of contact
-
-		Vector3 v0 = pnodeA->GetLinearVelocity()
-			+ Vector3::Cross(pnodeA->GetAngularVelocity(), r1);
-
-		Vector3 v1 = pnodeB->GetLinearVelocity()
-			+ Vector3::Cross(pnodeB->GetAngularVelocity(), r2);
-
-		//Relative velocity in constraint direction
-		float abnVel = Vector3::Dot(v0 - v1, abn);
-
 		//Compute the 'mass' of the constraint
 		//e.g. How difficult it is to move the two objects in
 		//the direction of the constraint
@@ -76,70 +68,50 @@ public:
 				* Vector3::Cross(r2, abn), r2));
 
 
-		float constraintMass = invConstraintMassLin + invConstraintMassRot;
+		constraintMass = invConstraintMassLin + invConstraintMassRot;
 
+		//This term is the only difference between DistanceConstraint and SpringConstraint
+		//https://www.gamedev.net/articles/programming/math-and-physics/towards-a-simpler-stiffer-and-more-stable-spring-r3227/
+		const float k = 0.01f;
+		float distance_offset = ab.Length() - targetLength;
+		springTerm = (constraintMass > 0.0f) ? (distance_offset * k) / (constraintMass * dt) : 0.0f;
+	}
+
+	//Solves the constraint and applies a velocity impulse to the two
+	// objects in order to satisfy the constraint.
+	virtual float ApplyImpulse(SolverBodies& bodies) override
+	{
 		if (constraintMass > 0.0f)
 		{
-			//Baumgarte Offset (Adds energy to the system to counter
-			//slight solving errors that accumulate over time - known
-			//as 'constraint drift')
-
-			//Experiment by commenting this out and see how it
-			//affects the constraints over time and when you manually
-			//move the objects apart.
+			//Compute the velocity of objects A and B at the point of contact
 
-			//The key is to find a nice value that is small enough
-			//not to cause objects to explode but also enough to make
-			//sure all constraints /will/ be satisfied. This value
-			//(0.1) will change based on your physics objects,
-			//timestep etc., and also how many constraints you are
-			//chaining together.
+			Vector3 v0 = bodies.GetVelocityAt(bodyA, r1);
 
-			float b = 0.0f;
+			Vector3 v1 = bodies.GetVelocityAt(bodyB, r2);
 
-			//-Optional-
-			float distance_offset = ab.Length() - targetLength;
-			float baumgarte_scalar = 0.1f;
-			b = -(baumgarte_scalar
-				/ PhysicsEngine::Instance()->GetDeltaTime())
-				* distance_offset;
-
-			//-Eof Optional-
+			//Relative velocity in constraint direction
+			float abnVel = Vector3::Dot(v0 - v1, abn);
 
 			//Compute velocity impulse (jn)
-			//In order to satisfy the distance constraints we need
-			//to apply forces to ensure the relative velocity
-			//(abnVel) in the direction of the constraint is zero.
-			//So we take inverse of the current rel velocity and
-			//multiply it by how hard it will be to move the objects.
-
-			//Note: We also add in any extra energy to the system
-			//here, e.g. baumgarte (and later elasticity)
-
-			//This line is the only difference between DistanceConstraint and SpringConstraint
-			//https://www.gamedev.net/articles/programming/math-and-physics/towards-a-simpler-stiffer-and-more-stable-spring-r3227/
-			const float k = 0.01f;
+			//Spring force pulling the objects back to the target length, damped by their relative velocity
 			const float c = 0.01f;
-			float jn = (distance_offset * k) / (constraintMass * PhysicsEngine::Instance()->GetDeltaTime()) - (c * abnVel);
-
-			//Apply linear velocity impulse
+			float jn = springTerm - (c * abnVel);
 
-			pnodeA->SetLinearVelocity(pnodeA->GetLinearVelocity()
-				+ abn * (pnodeA->GetInverseMass() * jn));
+			//Apply linear and rotational velocity impulse
 
-			pnodeB->SetLinearVelocity(pnodeB->GetLinearVelocity()
-				- abn * (pnodeB->GetInverseMass() * jn));
+			bodies.ApplyImpulse(bodyA, abn * jn, r1);
 
-			//Apply rotational velocity impulse
+			bodies.ApplyImpulse(bodyB, -abn * jn, r2);
 
-			pnodeA->SetAngularVelocity(pnodeA->GetAngularVelocity()
-				+ pnodeA->GetInverseInertia() * Vector3::Cross(r1, abn * jn));
-
-			pnodeB->SetAngularVelocity(pnodeB->GetAngularVelocity()
-				- pnodeB->GetInverseInertia() * Vector3::Cross(r2, abn * jn));
+			return fabs(jn * constraintMass);
 		}
+
+		return 0.0f;
 	}
 
+	virtual PhysicsNode* NodeA() const { return pnodeA; }
+	virtual PhysicsNode* NodeB() const { return pnodeB; }
+
 	//Draw the constraint visually to the screen for debugging
 	virtual void DebugDraw() const
 	{
@@ -158,4 +130,11 @@ protected:
 
 	Vector3 relPosA;
 	Vector3 relPosB;
+
+	//Computed in PreSolverStep
+	unsigned int bodyA, bodyB;
+	Vector3 r1, r2;
+	Vector3 abn;
+	float   constraintMass;
+	float   springTerm;
 };
\ No newline at end of file
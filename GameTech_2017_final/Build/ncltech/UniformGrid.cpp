@@ -0,0 +1,272 @@
+#include "UniformGrid.h"
+#include <omp.h>
+
+UniformGrid::UniformGrid()
+{
+	m_cellStart.resize(UNIFORM_GRID_NUM_CELLS, UNIFORM_GRID_EMPTY);
+	m_cellEnd.resize(UNIFORM_GRID_NUM_CELLS, UNIFORM_GRID_EMPTY);
+}
+
+UniformGrid::UniformGrid(std::vector<PhysicsNode*>& pNodes)
+	: UniformGrid()
+{
+	for (PhysicsNode* pNode : pNodes)
+	{
+		InsertObject(pNode);
+	}
+}
+
+UniformGrid::~UniformGrid()
+{
+	Clear();
+}
+
+void UniformGrid::InsertObject(PhysicsNode* pNode)
+{
+	//Already added
+	if (m_lookup.find(pNode) != m_lookup.end())
+	{
+		return;
+	}
+
+	m_lookup[pNode] = (unsigned int)m_physicsNodes.size();
+	m_physicsNodes.push_back(pNode);
+}
+
+void UniformGrid::RemoveObject(PhysicsNode* pNode)
+{
+	auto found = m_lookup.find(pNode);
+	if (found == m_lookup.end())
+	{
+		return;
+	}
+
+	//Swap and pop, the grid is rebuilt every update so the order doesn't matter
+	unsigned int idx = found->second;
+	m_lookup.erase(found);
+
+	m_physicsNodes[idx] = m_physicsNodes.back();
+	m_physicsNodes.pop_back();
+	if (idx < m_physicsNodes.size())
+	{
+		m_lookup[m_physicsNodes[idx]] = idx;
+	}
+
+	//The cell tables now refer to nodes that may not exist so clear them
+	for (unsigned int cellHash : m_cellIndices)
+	{
+		m_cellStart[cellHash] = UNIFORM_GRID_EMPTY;
+		m_cellEnd[cellHash] = UNIFORM_GRID_EMPTY;
+	}
+	m_cellIndices.clear();
+	m_sortedNodes.clear();
+}
+
+void UniformGrid::Clear()
+{
+	m_physicsNodes.clear();
+	m_lookup.clear();
+	m_bounds.clear();
+	m_largeNodes.clear();
+	m_cellIndices.clear();
+	m_sortedNodes.clear();
+	std::fill(m_cellStart.begin(), m_cellStart.end(), UNIFORM_GRID_EMPTY);
+	std::fill(m_cellEnd.begin(), m_cellEnd.end(), UNIFORM_GRID_EMPTY);
+}
+
+void UniformGrid::UpdateObjects()
+{
+	const int numNodes = (int)m_physicsNodes.size();
+
+	//Clear the cells used last update
+	for (unsigned int cellHash : m_cellIndices)
+	{
+		m_cellStart[cellHash] = UNIFORM_GRID_EMPTY;
+		m_cellEnd[cellHash] = UNIFORM_GRID_EMPTY;
+	}
+
+	//Update the bounds and find the largest node that will go in the grid, which sets the cell size
+	m_bounds.resize(numNodes);
+	m_largeNodes.clear();
+	m_sortedNodes.clear();
+	float cellSize = 0.0f;
+	for (int i = 0; i < numNodes; ++i)
+	{
+		m_bounds[i] = m_physicsNodes[i]->GetWorldSpaceAABB();
+
+		float size = GetNodeSize(m_bounds[i]);
+		if (size > UNIFORM_GRID_MAX_CELL_SIZE)
+		{
+			m_largeNodes.push_back(i);
+		}
+		else
+		{
+			m_sortedNodes.push_back(i);
+			cellSize = max(cellSize, size);
+		}
+	}
+
+	m_cellSize = max(cellSize, 0.01f);
+	m_invCellSize = 1.0f / m_cellSize;
+
+	//1: For each node, compute its grid cell index
+	const int numGridNodes = (int)m_sortedNodes.size();
+	m_cellIndices.resize(numGridNodes);
+
+#pragma omp parallel for schedule(static)
+	for (int i = 0; i < numGridNodes; ++i)
+	{
+		int x, y, z;
+		GetGridCell(GetNodeCentre(m_bounds[m_sortedNodes[i]]), x, y, z);
+		m_cellIndices[i] = GetGridCellHash(x, y, z);
+	}
+
+	//2: Sort the nodes by their grid cell indices
+	RadixSort();
+
+	//3: Save the start and end of each cell into the cell tables
+	for (int i = 0; i < numGridNodes; ++i)
+	{
+		unsigned int cellHash = m_cellIndices[i];
+		if (i == 0 || cellHash != m_cellIndices[i - 1])
+		{
+			m_cellStart[cellHash] = i;
+		}
+		if (i == numGridNodes - 1 || cellHash != m_cellIndices[i + 1])
+		{
+			m_cellEnd[cellHash] = i + 1;
+		}
+	}
+}
+
+void UniformGrid::GenPairs(std::vector<CollisionPair>& colPairs)
+{
+	const int numGridNodes = (int)m_sortedNodes.size();
+
+	m_threadPairs.resize(omp_get_max_threads());
+	for (std::vector<CollisionPair>& pairs : m_threadPairs)
+	{
+		pairs.clear();
+	}
+
+	//4: For each node, check all the nodes in its own and the neighbouring grid cells
+	// - The cell size is never smaller than a node so only a one cell radius needs checking
+#pragma omp parallel for schedule(static)
+	for (int i = 0; i < numGridNodes; ++i)
+	{
+		std::vector<CollisionPair>& pairs = m_threadPairs[omp_get_thread_num()];
+
+		int cx, cy, cz;
+		GetGridCell(GetNodeCentre(m_bounds[m_sortedNodes[i]]), cx, cy, cz);
+
+		for (int z = -1; z <= 1; ++z)
+		{
+			for (int x = -1; x <= 1; ++x)
+			{
+				for (int y = -1; y <= 1; ++y)
+				{
+					CollideWithCell(i, GetGridCellHash(cx + x, cy + y, cz + z), pairs);
+				}
+			}
+		}
+	}
+
+	//Merge the thread's pairs in thread order, each thread handles a fixed block of nodes so the
+	//order is the same every update
+	for (std::vector<CollisionPair>& pairs : m_threadPairs)
+	{
+		colPairs.insert(colPairs.end(), pairs.begin(), pairs.end());
+	}
+
+	//Nodes too big for the grid are checked against every other node
+	for (size_t i = 0; i < m_largeNodes.size(); ++i)
+	{
+		unsigned int idxA = m_largeNodes[i];
+		PhysicsNode* pnodeA = m_physicsNodes[idxA];
+
+		for (unsigned int idxB = 0; idxB < m_physicsNodes.size(); ++idxB)
+		{
+			//Only generate pairs between two large nodes once
+			PhysicsNode* pnodeB = m_physicsNodes[idxB];
+			if (idxB == idxA || (idxB < idxA && GetNodeSize(m_bounds[idxB]) > UNIFORM_GRID_MAX_CELL_SIZE))
+			{
+				continue;
+			}
+
+			if (m_bounds[idxA].Intersects(m_bounds[idxB]) && IsBroadphasePair(pnodeA, pnodeB))
+			{
+				CollisionPair cp;
+				cp.pObjectA = pnodeA;
+				cp.pObjectB = pnodeB;
+				colPairs.push_back(cp);
+			}
+		}
+	}
+}
+
+void UniformGrid::RadixSort()
+{
+	//Least significant digit radix sort of the cell indices, 8 bits at a time
+	//The sort is stable so nodes in the same cell stay in the same order
+	const unsigned int numKeyBits = UNIFORM_GRID_BITS * 3;
+	const size_t count = m_cellIndices.size();
+
+	std::vector<unsigned int>& tempKeys = m_sortTemp[0];
+	std::vector<unsigned int>& tempNodes = m_sortTemp[1];
+	tempKeys.resize(count);
+	tempNodes.resize(count);
+
+	for (unsigned int shift = 0; shift < numKeyBits; shift += 8)
+	{
+		unsigned int offsets[256] = { 0 };
+		for (size_t i = 0; i < count; ++i)
+		{
+			offsets[(m_cellIndices[i] >> shift) & 0xff]++;
+		}
+
+		//Prefix sum the digit counts into the start of each digit's output range
+		unsigned int sum = 0;
+		for (int d = 0; d < 256; ++d)
+		{
+			unsigned int c = offsets[d];
+			offsets[d] = sum;
+			sum += c;
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			unsigned int dst = offsets[(m_cellIndices[i] >> shift) & 0xff]++;
+			tempKeys[dst] = m_cellIndices[i];
+			tempNodes[dst] = m_sortedNodes[i];
+		}
+
+		m_cellIndices.swap(tempKeys);
+		m_sortedNodes.swap(tempNodes);
+	}
+}
+
+void UniformGrid::CollideWithCell(unsigned int sortedIdx, unsigned int cellHash, std::vector<CollisionPair>& colPairs)
+{
+	unsigned int start = m_cellStart[cellHash];
+	if (start == UNIFORM_GRID_EMPTY)
+	{
+		return;
+	}
+	unsigned int end = m_cellEnd[cellHash];
+
+	const unsigned int idxA = m_sortedNodes[sortedIdx];
+	PhysicsNode* pnodeA = m_physicsNodes[idxA];
+
+	//Each pair is found by both nodes so only keep the one found by the node with the lower sorted index
+	for (unsigned int j = max(start, sortedIdx + 1); j < end; ++j)
+	{
+		const unsigned int idxB = m_sortedNodes[j];
+		if (m_bounds[idxA].Intersects(m_bounds[idxB]) && IsBroadphasePair(pnodeA, m_physicsNodes[idxB]))
+		{
+			CollisionPair cp;
+			cp.pObjectA = pnodeA;
+			cp.pObjectB = m_physicsNodes[idxB];
+			colPairs.push_back(cp);
+		}
+	}
+}
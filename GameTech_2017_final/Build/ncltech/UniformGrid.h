@@ -0,0 +1,105 @@
+#pragma once
+
+#include "PhysicsNode.h"
+#include "BoundingBox.h"
+#include <vector>
+#include <unordered_map>
+
+//Uniform grid (spatial hash) broadphase
+//
+//This is the CPU version of the bucket sort grid used by CudaCollidingParticles:
+//		1: For each node, compute its grid cell index
+//		2: Sort the nodes by their grid cell indices (radix sort)
+//		3: Run through the sorted cell indices and save the 'start' and 'end' of each cell into the cell tables
+//		4: For each node, check the nodes in its own and the 26 neighbouring cells
+//
+//The grid wraps around every UNIFORM_GRID_SIZE cells so it has no world bounds - far away nodes can share a
+//cell index but are then rejected by the bounding box check. The cell size is set each update to the size of
+//the largest node, and nodes are binned by the centre of their bounding box (not their position, which
+//needn't be in the middle of a convex hull's box), so a node can only overlap nodes in neighbouring cells. Nodes bigger than
+//UNIFORM_GRID_MAX_CELL_SIZE (floors, walls etc.) would make the cells far too big so they are kept out of the
+//grid and checked against every other node instead.
+//
+//Computing the cell indices and checking the neighbouring cells is done in parallel with OpenMP.
+
+#define UNIFORM_GRID_BITS 6										//Number of bits used for each axis of a cell index
+#define UNIFORM_GRID_SIZE (1 << UNIFORM_GRID_BITS)				//Number of cells along each axis before the grid wraps
+#define UNIFORM_GRID_NUM_CELLS (UNIFORM_GRID_SIZE * UNIFORM_GRID_SIZE * UNIFORM_GRID_SIZE)
+#define UNIFORM_GRID_MAX_CELL_SIZE 4.0f							//Nodes larger than this are not put in the grid
+#define UNIFORM_GRID_EMPTY 0xffffffff							//Cell table entry for a cell with no nodes
+
+class UniformGrid
+{
+public:
+	UniformGrid();
+	UniformGrid(std::vector<PhysicsNode*>& pNodes);
+	~UniformGrid();
+
+	//Add/remove a single node
+	void InsertObject(PhysicsNode* pNode);
+	void RemoveObject(PhysicsNode* pNode);
+	void Clear();
+
+	//Compute the cell of each node, sort the nodes by cell and build the cell tables
+	void UpdateObjects();
+
+	//Check each node against the nodes in its own and neighbouring cells
+	void GenPairs(std::vector<CollisionPair>& colPairs);
+
+	inline float GetCellSize() const { return m_cellSize; }
+
+protected:
+	//Largest dimension of a node's bounds, a node this size can only overlap nodes in neighbouring cells
+	static inline float GetNodeSize(const BoundingBox& bounds)
+	{
+		const Vector3 size = bounds._max - bounds._min;
+		return max(size.x, max(size.y, size.z));
+	}
+
+	//Centre of a node's bounds, which decides the cell it goes in
+	static inline Vector3 GetNodeCentre(const BoundingBox& bounds)
+	{
+		return (bounds._min + bounds._max) * 0.5f;
+	}
+
+	//Cell containing the given position
+	inline void GetGridCell(const Vector3& pos, int& x, int& y, int& z) const
+	{
+		x = (int)floorf(pos.x * m_invCellSize);
+		y = (int)floorf(pos.y * m_invCellSize);
+		z = (int)floorf(pos.z * m_invCellSize);
+	}
+
+	//Generate a unique 'cell index' for the given cell, wrapping every UNIFORM_GRID_SIZE cells
+	static inline unsigned int GetGridCellHash(int x, int y, int z)
+	{
+		x &= UNIFORM_GRID_SIZE - 1;
+		y &= UNIFORM_GRID_SIZE - 1;
+		z &= UNIFORM_GRID_SIZE - 1;
+		return (((z << UNIFORM_GRID_BITS) + x) << UNIFORM_GRID_BITS) + y;
+	}
+
+	//Sort m_cellIndices and m_sortedNodes by cell index
+	void RadixSort();
+
+	//Check every node in the cell against the node, adding pairs where the node's sorted index is lower
+	void CollideWithCell(unsigned int sortedIdx, unsigned int cellHash, std::vector<CollisionPair>& colPairs);
+
+	std::vector<PhysicsNode*> m_physicsNodes;
+	std::unordered_map<PhysicsNode*, unsigned int> m_lookup;
+
+	float m_cellSize = 1.0f;
+	float m_invCellSize = 1.0f;
+
+	std::vector<BoundingBox> m_bounds;					//Bounds of each node this update
+	std::vector<unsigned int> m_largeNodes;				//Nodes too big for the grid
+
+	std::vector<unsigned int> m_cellIndices;			//Cell index of each node in the grid, sorted
+	std::vector<unsigned int> m_sortedNodes;			//Index of each node in the grid, sorted by cell index
+	std::vector<unsigned int> m_sortTemp[2];			//Radix sort double buffers
+
+	std::vector<unsigned int> m_cellStart;				//First sorted index in each cell
+	std::vector<unsigned int> m_cellEnd;				//One past the last sorted index in each cell
+
+	std::vector<std::vector<CollisionPair>> m_threadPairs;	//Pairs found by each thread, merged in order so the result is deterministic
+};